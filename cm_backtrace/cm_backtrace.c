@@ -31,6 +31,10 @@
 #include <string.h>
 #include <stdio.h>
 
+#if defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH)
+#include <finsh.h>
+#endif
+
 #if __STDC_VERSION__ < 199901L
     #error "must be C99 or higher. try to add '-std=c99' to compile parameters"
 #endif
@@ -49,14 +53,33 @@
     extern const int CSTACK_BLOCK_END(CMB_CSTACK_BLOCK_NAME);
     extern const int CODE_SECTION_START(CMB_CODE_SECTION_NAME);
     extern const int CODE_SECTION_END(CMB_CODE_SECTION_NAME);
+#ifdef CMB_USING_ASSERT_REGISTRY
+    #define ASSERT_SITE_START                    ((const struct cmb_assert_site *) &SECTION_START(CMB_ASSERT_SITE))
+    #define ASSERT_SITE_END                      ((const struct cmb_assert_site *) &SECTION_END(CMB_ASSERT_SITE))
+
+    extern const int SECTION_START(CMB_ASSERT_SITE);
+    extern const int SECTION_END(CMB_ASSERT_SITE);
+#endif
 #elif defined(__ICCARM__)
     #pragma section=CMB_CSTACK_BLOCK_NAME
     #pragma section=CMB_CODE_SECTION_NAME
+#ifdef CMB_USING_ASSERT_REGISTRY
+    #pragma section="CMB_ASSERT_SITE"
+    #define ASSERT_SITE_START                    ((const struct cmb_assert_site *) __section_begin("CMB_ASSERT_SITE"))
+    #define ASSERT_SITE_END                      ((const struct cmb_assert_site *) __section_end("CMB_ASSERT_SITE"))
+#endif
 #elif defined(__GNUC__)
     extern const int CMB_CSTACK_BLOCK_START;
     extern const int CMB_CSTACK_BLOCK_END;
     extern const int CMB_CODE_SECTION_START;
     extern const int CMB_CODE_SECTION_END;
+#ifdef CMB_USING_ASSERT_REGISTRY
+    #define ASSERT_SITE_START                    CMB_ASSERT_SITE_START
+    #define ASSERT_SITE_END                      CMB_ASSERT_SITE_END
+
+    extern const struct cmb_assert_site CMB_ASSERT_SITE_START[];
+    extern const struct cmb_assert_site CMB_ASSERT_SITE_END[];
+#endif
 #else
     #error "not supported compiler"
 #endif
@@ -99,6 +122,54 @@ enum {
     PRINT_DFSR_EXTERNAL,
     PRINT_MMAR,
     PRINT_BFAR,
+    PRINT_SIGNATURE,
+    PRINT_SIGNATURE_COUNT,
+    PRINT_BKP_RECORD,
+    PRINT_FAULT_PC_LR,
+    PRINT_ALL_THREADS_TITLE,
+    PRINT_THREAD_CALL_STACK,
+    PRINT_THREAD_CALL_STACK_ERR,
+    PRINT_STACK_HWM_TITLE,
+    PRINT_STACK_HWM,
+    PRINT_STACK_HWM_WARN,
+    PRINT_STACK_OVERFLOW_ON_SWITCH,
+    PRINT_STACK_OWNER,
+    PRINT_STACK_OWNER_OTHER,
+    PRINT_STACK_OWNER_DROPPED,
+    PRINT_SWITCH_RECORDER_TITLE,
+    PRINT_SWITCH_RECORDER_RESET_TITLE,
+    PRINT_SWITCH_RECORD,
+    PRINT_IRQ_RECORDER_TITLE,
+    PRINT_IRQ_RECORDER_RESET_TITLE,
+    PRINT_IRQ_RECORD,
+    PRINT_HANG_ON_THREAD,
+    PRINT_HANG_ON_HANDLER,
+    PRINT_HANG_IPC_TITLE,
+    PRINT_HANG_IPC_MUTEX,
+    PRINT_HANG_IPC_SEMAPHORE,
+    PRINT_HANG_RECORD,
+    PRINT_TICK_SAMPLER_TITLE,
+    PRINT_TICK_SAMPLE,
+    PRINT_PROFILER_TITLE,
+    PRINT_IPC_PROFILER_TITLE,
+    PRINT_IPC_CONTENTION,
+    PRINT_HEAP_TRACKER_TITLE,
+    PRINT_HEAP_SITE,
+    PRINT_HEAP_CORRUPTED,
+    PRINT_HEAP_FAULT_BLOCK,
+    PRINT_THREAD_FAULT_RECOVERED,
+    PRINT_SOFT_ASSERT_ON_THREAD,
+    PRINT_SOFT_ASSERT_ON_HANDLER,
+    PRINT_SOFT_ASSERT_DROPPED,
+    PRINT_ASSERT_SITE,
+    PRINT_ASSERT_SITE_TITLE,
+    PRINT_PHASE_TIMING_TITLE,
+    /* the phase timings are in same order as CMB_PHASE_XXX */
+    PRINT_PHASE_CAPTURE,
+    PRINT_PHASE_STACK_SCAN,
+    PRINT_PHASE_DIAGNOSIS,
+    PRINT_PHASE_DUMP_STACK,
+    PRINT_PHASE_REPORT,
 };
 
 static const char * const print_info[] = {
@@ -140,6 +211,58 @@ static const char * const print_info[] = {
         [PRINT_DFSR_EXTERNAL]         = "Debug fault is caused by EDBGRQ signal asserted",
         [PRINT_MMAR]                  = "The memory management fault occurred address is %08x",
         [PRINT_BFAR]                  = "The bus fault occurred address is %08x",
+        [PRINT_SIGNATURE]             = "Crash signature: %08x",
+        [PRINT_SIGNATURE_COUNT]       = "Crash signature: %08x, occurred %lu times",
+        [PRINT_FAULT_PC_LR]           = "Fault PC: %08x, LR: %08x",
+        [PRINT_BKP_RECORD]            = "Last fault record: signature: %08x, PC: %08x, LR: %08x, thread: %08x, cause: %08x",
+        [PRINT_ALL_THREADS_TITLE]     = "================== All threads call stack ===================",
+        [PRINT_THREAD_CALL_STACK]     = "Thread %s: addr2line -e %s%s -a -f %.*s",
+        [PRINT_THREAD_CALL_STACK_ERR] = "Thread %s: dump call stack has an error",
+        [PRINT_STACK_HWM_TITLE]       = "================= Stack high-water mark =================",
+        [PRINT_STACK_HWM]             = "%-16s size: %6u, max used: %6u, headroom: %3u%%",
+        [PRINT_STACK_HWM_WARN]        = "Warning: %s stack headroom is only %u%% (%u bytes)",
+        [PRINT_STACK_OVERFLOW_ON_SWITCH] = "Stack overflow on thread %.*s(%08x) (context switch check), stack: %08x, size: %u, SP: %08x, max used: %u",
+        [PRINT_STACK_OWNER]           = "%-4s %08x is on the stack of %s(%08x)",
+        [PRINT_STACK_OWNER_OTHER]     = "%-4s %08x is on the stack of %s(%08x), it isn't the faulted context (cross stack access or corruption)",
+        [PRINT_STACK_OWNER_DROPPED]   = "%u threads aren't on the stack owner index, it's full (CMB_THREAD_MAX_NUM)",
+        [PRINT_SWITCH_RECORDER_TITLE] = "============= Last context switches (oldest first) ==========",
+        [PRINT_SWITCH_RECORDER_RESET_TITLE] = "======= Last context switches before reset (oldest first) ======",
+        [PRINT_SWITCH_RECORD]         = "%10u: %.*s(%08x) -> %.*s(%08x), PC: %08x",
+        [PRINT_IRQ_RECORDER_TITLE]    = "============= Last interrupt entries (oldest first) =========",
+        [PRINT_IRQ_RECORDER_RESET_TITLE] = "======= Last interrupt entries before reset (oldest first) ======",
+        [PRINT_IRQ_RECORD]            = "%10u: exception %3u (IRQ %3d), preempted PC: %08x",
+        [PRINT_HANG_ON_THREAD]        = "Hang on thread %s (watchdog early warning)",
+        [PRINT_HANG_ON_HANDLER]       = "Hang on interrupt (watchdog early warning)",
+        [PRINT_HANG_IPC_TITLE]        = "=============== IPC owners and waiters ===============",
+        [PRINT_HANG_IPC_MUTEX]        = "Mutex %.*s(%08x): owner: %.*s, hold: %u, waiters: %u, first waiter: %.*s",
+        [PRINT_HANG_IPC_SEMAPHORE]    = "Semaphore %.*s(%08x): value: %u, waiters: %u, first waiter: %.*s",
+        [PRINT_HANG_RECORD]           = "Last hang record: signature: %08x, thread: %08x, threads: %u, IPC objects: %u",
+        [PRINT_TICK_SAMPLER_TITLE]    = "========= Last tick samples before reset (oldest first) =========",
+        [PRINT_TICK_SAMPLE]           = "PC: %08x, LR: %08x, thread: %08x",
+        [PRINT_PROFILER_TITLE]        = "Profiler samples: %u, dropped: %u, folded stacks:",
+        [PRINT_IPC_PROFILER_TITLE]    = "IPC contention call sites: %u, dropped: %u, top %u by total wait:",
+        [PRINT_IPC_CONTENTION]        = "%.*s(%08x): waits: %u, total: %u, max: %u, last holder: %.*s, addr2line -e %s%s -a -f %.*s",
+        [PRINT_HEAP_TRACKER_TITLE]    = "Heap live bytes: %u, live blocks: %u, untracked: %u, top %u sites by live bytes:",
+        [PRINT_HEAP_SITE]             = "live bytes: %6u, live blocks: %4u, allocs: %6u, addr2line -e %s%s -a -f %.*s",
+        [PRINT_HEAP_CORRUPTED]        = "Heap is corrupted at block %08x (heap: %08x - %08x)",
+        [PRINT_HEAP_FAULT_BLOCK]      = "Fault address %08x is on heap block %08x (size: %u, used: %u), the heap is OK",
+#if (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_SUSPEND)
+        [PRINT_THREAD_FAULT_RECOVERED] = "Thread %s is suspended by fault, the other threads keep running",
+#else
+        [PRINT_THREAD_FAULT_RECOVERED] = "Thread %s is deleted by fault, the other threads keep running",
+#endif
+        [PRINT_SOFT_ASSERT_ON_THREAD] = "Soft assert %08x on thread %.*s, hits: %u, addr2line -e %s%s -a -f %.*s",
+        [PRINT_SOFT_ASSERT_ON_HANDLER] = "Soft assert %08x on interrupt or bare metal(no OS) environment, hits: %u, "
+                                        "addr2line -e %s%s -a -f %.*s",
+        [PRINT_SOFT_ASSERT_DROPPED]   = "Soft assert ring is full, %u records are dropped",
+        [PRINT_ASSERT_SITE]           = "Assert site %u (file: %u, line: %u), hits: %u",
+        [PRINT_ASSERT_SITE_TITLE]     = "Assert sites: %u, hit sites:",
+        [PRINT_PHASE_TIMING_TITLE]    = "============ Fault path timing (last / min / max) ============",
+        [PRINT_PHASE_CAPTURE]         = "  capture   : %10u / %10u / %10u",
+        [PRINT_PHASE_STACK_SCAN]      = "  stack scan: %10u / %10u / %10u",
+        [PRINT_PHASE_DIAGNOSIS]       = "  diagnosis : %10u / %10u / %10u",
+        [PRINT_PHASE_DUMP_STACK]      = "  dump stack: %10u / %10u / %10u",
+        [PRINT_PHASE_REPORT]          = "  report    : %10u / %10u / %10u",
 #elif (CMB_PRINT_LANGUAGE == CMB_PRINT_LANGUAGE_CHINESE)
         [PRINT_FIRMWARE_INFO]         = "̼ƣ%sӲ汾ţ%s汾ţ%s",
         [PRINT_ASSERT_ON_THREAD]      = "߳(%s)з",
@@ -178,6 +301,57 @@ static const char * const print_info[] = {
         [PRINT_DFSR_EXTERNAL]         = "Դԭⲿ",
         [PRINT_MMAR]                  = "洢ĵַ%08x",
         [PRINT_BFAR]                  = "ߴĵַ%08x",
+        [PRINT_SIGNATURE]             = "ǩ%08x",
+        [PRINT_SIGNATURE_COUNT]       = "ǩ%08xۼƷ %lu ",
+        [PRINT_FAULT_PC_LR]           = " PC%08xLR%08x",
+        [PRINT_BKP_RECORD]            = "ϴιϼ¼ǩ%08xPC%08xLR%08x̣߳%08xԭ%08x",
+        [PRINT_ALL_THREADS_TITLE]     = "======================= ̺߳ջ ======================",
+        [PRINT_THREAD_CALL_STACK]     = "߳(%s)addr2line -e %s%s -a -f %.*s",
+        [PRINT_THREAD_CALL_STACK_ERR] = "߳(%s)ȡջʧ",
+        [PRINT_STACK_HWM_TITLE]       = "======================= ջʹ÷ֵ =======================",
+        [PRINT_STACK_HWM]             = "%-16s С%6uʹã%6uʣࣺ%3u%%",
+        [PRINT_STACK_HWM_WARN]        = "棺%s ջʣռΪ %u%%%u ֽڣ",
+        [PRINT_STACK_OVERFLOW_ON_SWITCH] = "߳(%.*s)(%08x)ջ߳лʱ飩ջ%08xС%uSP%08xʹã%u",
+        [PRINT_STACK_OWNER]           = "%-4s %08x λ %s(%08x) ջ",
+        [PRINT_STACK_OWNER_OTHER]     = "%-4s %08x λ %s(%08x) ջУڷ쳣ģջʻջƻ",
+        [PRINT_STACK_OWNER_DROPPED]   = "ջCMB_THREAD_MAX_NUM%u ̲߳",
+        [PRINT_SWITCH_RECORDER_TITLE] = "================== ߳л¼ɾɵ£ ==================",
+        [PRINT_SWITCH_RECORDER_RESET_TITLE] = "============== λǰ߳л¼ɾɵ£ ==============",
+        [PRINT_SWITCH_RECORD]         = "%10u%.*s(%08x) -> %.*s(%08x)PC%08x",
+        [PRINT_IRQ_RECORDER_TITLE]    = "================== жϼ¼ɾɵ£ ==================",
+        [PRINT_IRQ_RECORDER_RESET_TITLE] = "=============== λǰжϼ¼ɾɵ£ ===============",
+        [PRINT_IRQ_RECORD]            = "%10u쳣 %3u (IRQ %3d)ռ PC%08x",
+        [PRINT_HANG_ON_THREAD]        = "߳(%s)зŹǰԤ",
+        [PRINT_HANG_ON_HANDLER]       = "жзŹǰԤ",
+        [PRINT_HANG_IPC_TITLE]        = "===================== IPC ߼ȴ =====================",
+        [PRINT_HANG_IPC_MUTEX]        = " %.*s(%08x)ߣ%.*sд%uȴ߳%u׸ȴ̣߳%.*s",
+        [PRINT_HANG_IPC_SEMAPHORE]    = "ź %.*s(%08x)ֵ%uȴ߳%u׸ȴ̣߳%.*s",
+        [PRINT_HANG_RECORD]           = "ϴο¼ǩ%08x̣߳%08x߳%uIPC %u",
+        [PRINT_TICK_SAMPLER_TITLE]    = "================ λǰĽĲɾɵ£ ================",
+        [PRINT_TICK_SAMPLE]           = "PC%08xLR%08x̣߳%08x",
+        [PRINT_PROFILER_TITLE]        = "ܷ%u%u۵ջ",
+        [PRINT_IPC_PROFILER_TITLE]    = "IPC õõ%u%uܵȴʱǰ %u ",
+        [PRINT_IPC_CONTENTION]        = "%.*s(%08x)ȴ%uܵȴ%uȴ%uߣ%.*saddr2line -e %s%s -a -f %.*s",
+        [PRINT_HEAP_TRACKER_TITLE]    = "Ѵֽ%u%uδ%uֽǰ %u ķ㣺",
+        [PRINT_HEAP_SITE]             = "ֽ%6u%4u%6uaddr2line -e %s%s -a -f %.*s",
+        [PRINT_HEAP_CORRUPTED]        = "ڴ %08x ƻѣ%08x - %08x",
+        [PRINT_HEAP_FAULT_BLOCK]      = "ϵַ %08x λڶڴ %08xС%uʹã%u",
+#if (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_SUSPEND)
+        [PRINT_THREAD_FAULT_RECOVERED] = "߳(%s)쳣̼߳",
+#else
+        [PRINT_THREAD_FAULT_RECOVERED] = "߳(%s)쳣ɾ̼߳",
+#endif
+        [PRINT_SOFT_ASSERT_ON_THREAD] = " %08x ߳(%.*s)Уۼ %u Σaddr2line -e %s%s -a -f %.*s",
+        [PRINT_SOFT_ASSERT_ON_HANDLER] = " %08x жϻ£ۼ %u Σaddr2line -e %s%s -a -f %.*s",
+        [PRINT_SOFT_ASSERT_DROPPED]   = "Ի %u ¼",
+        [PRINT_ASSERT_SITE]           = "Ե %uļ%uкţ%uۼ %u ",
+        [PRINT_ASSERT_SITE_TITLE]     = "Ե%uѴĶԵ㣺",
+        [PRINT_PHASE_TIMING_TITLE]    = "================ ϴʱ / С /  ================",
+        [PRINT_PHASE_CAPTURE]         = "  ɼĴ%10u / %10u / %10u",
+        [PRINT_PHASE_STACK_SCAN]      = "  ɨջ%10u / %10u / %10u",
+        [PRINT_PHASE_DIAGNOSIS]       = "    %10u / %10u / %10u",
+        [PRINT_PHASE_DUMP_STACK]      = "  ջݣ%10u / %10u / %10u",
+        [PRINT_PHASE_REPORT]          = "  Ϣ  %10u / %10u / %10u",
 #else
     #error "CMB_PRINT_LANGUAGE defined error in 'cmb_cfg.h'"
 #endif
@@ -201,488 +375,4936 @@ static bool statck_has_fpu_regs = false;
 #endif
 
 static bool on_thread_before_fault = false;
+static uint32_t call_stack_buf[CMB_CALL_STACK_MAX_DEPTH] = { 0 };
+static size_t call_stack_depth = 0;
+static uint32_t last_signature = 0;
+static uint32_t fault_stack_pointer = 0;
+static uint32_t fault_stack_start_addr = 0;
+static size_t fault_stack_size = 0;
+#ifdef CMB_USING_OS_PLATFORM
+static const char *fault_thread_name = NULL;
+#endif
 
-/**
- * library initialize
- */
-void cm_backtrace_init(const char *firmware_name, const char *hardware_ver, const char *software_ver) {
-    strncpy(fw_name, firmware_name, CMB_NAME_MAX);
-    strncpy(hw_ver, hardware_ver, CMB_NAME_MAX);
-    strncpy(sw_ver, software_ver, CMB_NAME_MAX);
+#ifdef CMB_USING_OS_PLATFORM
+/* the FPU registers are saved on thread switch by OS port when the hardware FPU is enabled on compiler */
+#if ((CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)) \
+        && ((defined(__VFP_FP__) && !defined(__SOFTFP__)) || defined(__TARGET_FPU_VFP) || defined(__ARMVFP__))
+#define THREAD_FPU_CONTEXT
+#endif
+#endif /* CMB_USING_OS_PLATFORM */
 
-#if defined(__CC_ARM)
-    main_stack_start_addr = (uint32_t)&CSTACK_BLOCK_START(CMB_CSTACK_BLOCK_NAME);
-    main_stack_size = (uint32_t)&CSTACK_BLOCK_END(CMB_CSTACK_BLOCK_NAME) - main_stack_start_addr;
-    code_start_addr = (uint32_t)&CODE_SECTION_START(CMB_CODE_SECTION_NAME);
-    code_size = (uint32_t)&CODE_SECTION_END(CMB_CODE_SECTION_NAME) - code_start_addr;
-#elif defined(__ICCARM__)
-    main_stack_start_addr = (uint32_t)__section_begin(CMB_CSTACK_BLOCK_NAME);
-    main_stack_size = (uint32_t)__section_end(CMB_CSTACK_BLOCK_NAME) - main_stack_start_addr;
-    code_start_addr = (uint32_t)__section_begin(CMB_CODE_SECTION_NAME);
-    code_size = (uint32_t)__section_end(CMB_CODE_SECTION_NAME) - code_start_addr;
-#elif defined(__GNUC__)
-    main_stack_start_addr = (uint32_t)(&CMB_CSTACK_BLOCK_START);
-    main_stack_size = (uint32_t)(&CMB_CSTACK_BLOCK_END) - main_stack_start_addr;
-    code_start_addr = (uint32_t)(&CMB_CODE_SECTION_START);
-    code_size = (uint32_t)(&CMB_CODE_SECTION_END) - code_start_addr;
+#ifdef CMB_USING_STACK_HWM
+/* the main stack words under current MSP which are not painted on cm_backtrace_init */
+#define MAIN_STACK_PAINT_MARGIN        16
+#endif
+
+#if defined(CMB_USING_ALL_THREADS_BACKTRACE) || defined(CMB_USING_STACK_OWNER)
+static uint32_t fault_thread_id = 0;
+#endif
+#ifdef CMB_USING_ALL_THREADS_BACKTRACE
+static uint32_t thread_call_stack_buf[CMB_CALL_STACK_MAX_DEPTH] = { 0 };
+#endif
+
+#if defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+/* the words under the initial top of stack which are initialized by pxPortInitialiseStack, include the top word */
+#ifdef THREAD_FPU_CONTEXT
+#define FREERTOS_INIT_STACK_WORDS      18
 #else
-    #error "not supported compiler"
+#define FREERTOS_INIT_STACK_WORDS      17
+#endif
+/* the hardware saved stack frame words (R0~R3, R12, LR, PC, xPSR and S0~S15, FPSCR, reserved) */
+#ifdef THREAD_FPU_CONTEXT
+#define FREERTOS_FRAME_WORDS           26
+#else
+#define FREERTOS_FRAME_WORDS           8
+#endif
+/* the task stack bounds cache, the index is task number - 1 */
+static struct cmb_thread_info freertos_tasks[CMB_FREERTOS_TASK_MAX_NUM];
+static struct cmb_thread_info *freertos_cur_task = NULL;
 #endif
 
-    init_ok = true;
-}
+#ifdef CMB_USING_SWITCH_RECORDER
+#define SWITCH_RECORDER_MAGIC          0x434D5352
+/* retained over the warm reset */
+static CMB_NOINIT struct cmb_switch_recorder switch_recorder;
+#endif
 
-/**
- * print firmware information, such as: firmware name, hardware version, software version
- */
-void cm_backtrace_firmware_info(void) {
-    cmb_println(print_info[PRINT_FIRMWARE_INFO], fw_name, hw_ver, sw_ver);
-}
+#ifdef CMB_USING_IRQ_RECORDER
+#define IRQ_RECORDER_MAGIC             0x434D4952
+/* retained over the warm reset */
+static CMB_NOINIT struct cmb_irq_recorder irq_recorder;
+#endif
 
-#ifdef CMB_USING_OS_PLATFORM
-/**
- * Get current thread stack information
- *
- * @param sp stack current pointer
- * @param start_addr stack start address
- * @param size stack size
- */
-static void get_cur_thread_stack_info(uint32_t sp, uint32_t *start_addr, size_t *size) {
-    CMB_ASSERT(start_addr);
-    CMB_ASSERT(size);
+#ifdef CMB_USING_DEFERRED_REPORT
+static volatile bool report_pending = false;
+#endif
 
-#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
-    *start_addr = (uint32_t) rt_thread_self()->stack_addr;
-    *size = rt_thread_self()->stack_size;
-#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
-    extern OS_TCB *OSTCBCur;
+#ifdef CMB_USING_MPU_STACK_GUARD
+#define MPU_CTRL_ENABLE                (1UL << 0)
+/* the default memory map is used on the privileged access which is not in any region */
+#define MPU_CTRL_PRIVDEFENA            (1UL << 2)
+/* the region number is written by RBAR when the VALID bit is set */
+#define MPU_RBAR_VALID                 (1UL << 4)
+/* execute never, read-only, normal memory (write-back, read and write allocate), enabled, so the OS stack check and
+ * stack high-water mark still can read the guard */
+#define MPU_RASR_GUARD_ATTR            ((1UL << 28) | (6UL << 24) | (1UL << 19) | (1UL << 17) | (1UL << 16) | 1UL)
+/* the region base must be aligned to region size, so the guard is rounded up into the stack when the stack start
+ * address isn't aligned to CMB_MPU_STACK_GUARD_SIZE, the stack must be larger than twice of the guard size */
+#define MPU_STACK_GUARD_BASE(addr)                                             \
+    (((addr) + CMB_MPU_STACK_GUARD_SIZE - 1) & ~(uint32_t) (CMB_MPU_STACK_GUARD_SIZE - 1))
+/* MemManage fault on data access, the fault address is valid on MMAR */
+#define MPU_MFSR_DACCVIOL              (1UL << 1)
+#define MPU_MFSR_MMARVALID             (1UL << 7)
+/* MemManage fault on exception entry stacking */
+#define MPU_MFSR_MSTKERR               (1UL << 4)
+#if defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+/* the thread guard region which is on the switched in thread, the other one is still on the switched out thread */
+#define MPU_THREAD_GUARD_OTHER(region)                                         \
+    ((region) == CMB_MPU_THREAD_GUARD_REGION ? CMB_MPU_PREV_THREAD_GUARD_REGION : CMB_MPU_THREAD_GUARD_REGION)
+static uint32_t mpu_thread_guard_region = CMB_MPU_THREAD_GUARD_REGION;
+/* stack start address of the switched out thread which is still guarded */
+static uint32_t mpu_prev_guard_stack_start_addr = 0;
+#endif
+#endif
 
-    *start_addr = (uint32_t) OSTCBCur->OSTCBStkBottom;
-    *size = OSTCBCur->OSTCBStkSize * sizeof(OS_STK);
-#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
-    extern OS_TCB *OSTCBCurPtr; 
-    
-    *start_addr = (uint32_t) OSTCBCurPtr->StkBasePtr;
-    *size = OSTCBCurPtr->StkSize * sizeof(CPU_STK_SIZE);
-#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)   
-    *start_addr = (uint32_t)vTaskStackAddr();
-    *size = vTaskStackSize() * sizeof( StackType_t );
+#if defined(CMB_USING_DEFERRED_REPORT) || defined(CMB_USING_THREAD_FAULT_RECOVERY)
+/* the xPSR (only Thumb bit) which is redirected to the fault return function */
+#define FAULT_RETURN_PSR               0x01000000
+/* the stacked xPSR bit 9, the stack pointer was aligned to 8 bytes by one padding word on exception entry */
+#define FAULT_RETURN_PSR_ALIGN         (1UL << 9)
 #endif
-}
 
-/**
- * Get current thread name
- */
-static const char *get_cur_thread_name(void) {
-#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
-    return rt_thread_self()->name;
-#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
-    extern OS_TCB *OSTCBCur;
+#ifdef CMB_USING_THREAD_FAULT_RECOVERY
+/* the faulted thread is recovering, the fault is released after the report is printed */
+static volatile bool thread_fault_recovering = false;
+static void (*thread_fault_hook)(void *thread, uint32_t signature) = NULL;
+#endif
 
-#if OS_TASK_NAME_SIZE > 0 || OS_TASK_NAME_EN > 0
-        return (const char *)OSTCBCur->OSTCBTaskName;
+#ifdef CMB_USING_STACK_OWNER
+/* sorted by start address, it's changed with interrupts locked, so it can be searched on interrupt */
+static struct cmb_stack_owner stack_owners[CMB_THREAD_MAX_NUM + 1];
+static size_t stack_owner_num = 0;
+/* number of the threads which aren't indexed because the index is full */
+static size_t stack_owner_dropped = 0;
+#endif
+
+#ifdef CMB_USING_STACK_CHECK
+/* the stack overflow is recorded once, the overflowed thread may overflow again on each switch */
+static volatile bool stack_overflow_recorded = false;
+/* the record is printed out of the context switch by cm_backtrace_stack_overflow_report */
+static volatile bool stack_overflow_pending = false;
+static struct cmb_stack_overflow_record stack_overflow_record;
+#ifdef CMB_USING_SIG_TABLE
+static uint32_t stack_overflow_signature_count = 0;
+#endif
+static void (*stack_overflow_hook)(const struct cmb_stack_overflow_record *record) = NULL;
+#endif
+
+/* the watchdog will be fed after dumped the number of stack words */
+#define DUMP_STACK_FEED_WORDS          32
+
+/* the fault type for assert and the fault on Cortex-M0 which has no fault status registers */
+#define SIG_TYPE_ASSERT                0x00000000
+#define SIG_TYPE_FAULT                 0x80000000
+#define SIG_TYPE_HANG                  0x40000000
+#define SIG_TYPE_STACK_OVERFLOW        0x20000000
+
+#ifdef CMB_USING_BKP_RECORD
+/* backup register N */
+#define BKP_REG(N)                     (((volatile uint32_t *) (CMB_BKP_REG_BASE))[N])
+#define BKP_RECORD_MAGIC               0xCB5A
+static struct cmb_bkp_record bkp_record;
+static bool bkp_record_valid = false;
+#endif
+
+#ifdef CMB_USING_HANG_CAPTURE
+#define HANG_RECORD_MAGIC              0x434D4847
+/* the max number of scanned IPC objects on each class */
+#define HANG_IPC_SCAN_MAX_NUM          256
+/* retained over the watchdog reset */
+static CMB_NOINIT struct cmb_hang_record hang_record;
+static bool hang_record_valid = false;
+#endif
+
+#if defined(CMB_USING_PROFILER) || defined(CMB_USING_TICK_SAMPLER) || defined(CMB_USING_HANG_CAPTURE)
+/* the max scanned words for EXC_RETURN from the stack pointer of sampling */
+#define EXC_FRAME_SCAN_MAX_WORDS       64
+#endif
+
+#ifdef CMB_USING_TICK_SAMPLER
+#define TICK_SAMPLER_MAGIC             0x434D5453
+/* retained over the watchdog reset */
+static CMB_NOINIT struct cmb_tick_sampler tick_sampler;
+#endif
+
+#ifdef CMB_USING_PROFILER
+static volatile bool profiler_running = false;
+static uint32_t profiler_samples = 0;
+static uint32_t profiler_dropped = 0;
+static uint32_t profiler_call_stack[CMB_PROFILER_DEPTH];
+static struct cmb_profiler_record profiler_records[CMB_PROFILER_TABLE_SIZE];
+#endif
+
+#ifdef CMB_USING_IPC_PROFILER
+/* the thread which is going to block on IPC object */
+struct ipc_waiter {
+    uint32_t thread;                   /* waiter thread ID, 0: free */
+    uint32_t object;
+    uint32_t holder;                   /* holder thread ID (only for mutex), 0: no holder */
+    uint32_t start;                    /* start timestamp by cmb_get_timestamp() */
+    char holder_name[CMB_IPC_PROFILER_NAME_MAX]; /* the holder may be deleted before the take is finished */
+};
+
+static struct ipc_waiter ipc_waiters[CMB_IPC_PROFILER_WAITER_NUM];
+static uint32_t ipc_contention_num = 0;
+static uint32_t ipc_contention_dropped = 0;
+static struct cmb_ipc_contention ipc_contentions[CMB_IPC_PROFILER_TABLE_SIZE];
+#endif
+
+#ifdef CMB_USING_HEAP_TRACKER
+/* live allocation */
+struct heap_alloc {
+    uint32_t ptr;                      /* block address, 0: empty */
+    uint32_t size;
+    uint32_t site;                     /* index on site table */
+};
+
+static struct heap_alloc heap_allocs[CMB_HEAP_TRACKER_ALLOC_NUM];
+static struct cmb_heap_site heap_sites[CMB_HEAP_TRACKER_SITE_NUM];
+static uint32_t heap_live_bytes = 0;
+static uint32_t heap_live_num = 0;
+static uint32_t heap_untracked_num = 0;
+#endif
+
+#ifdef CMB_USING_SOFT_ASSERT
+/* soft assert record on lock-free ring */
+struct soft_assert_record {
+    volatile uint32_t seq;             /* ring position + 1: filled, ring position: free */
+    uint32_t site;
+    char thread[CMB_NAME_MAX];         /* thread name, empty: interrupt or bare metal, it's not terminated when the name
+                                          is too long */
+    uint32_t depth;
+    uint32_t call_stack[CMB_SOFT_ASSERT_DEPTH];
+};
+
+/* the soft assert hits of each site for rate limit */
+struct soft_assert_site {
+    uint32_t site;
+    uint32_t hits;                     /* 0: free */
+};
+
+static struct soft_assert_record soft_assert_ring[CMB_SOFT_ASSERT_RING_SIZE];
+static volatile uint32_t soft_assert_head = 0;
+static uint32_t soft_assert_tail = 0;
+static volatile uint32_t soft_assert_dropped = 0;
+static uint32_t soft_assert_dropped_printed = 0;
+static struct soft_assert_site soft_assert_sites[CMB_SOFT_ASSERT_SITE_NUM];
+#endif
+
+#ifdef CMB_USING_ASSERT_REGISTRY
+/* the hits of each assert site, the index is same as the assert site section */
+static uint32_t assert_site_hits[CMB_ASSERT_SITE_MAX_NUM];
+#endif
+
+#ifdef CMB_USING_PHASE_TIMING
+static struct cmb_phase_timing phase_timing;
+#define PHASE_START(start)             ((start) = cmb_get_timestamp())
+#define PHASE_RECORD(phase, start)     phase_record(phase, start)
 #else
-        return NULL;
-#endif /* OS_TASK_NAME_SIZE > 0 || OS_TASK_NAME_EN > 0 */
+#define PHASE_START(start)             ((void) 0)
+#define PHASE_RECORD(phase, start)     ((void) 0)
+#endif
 
-#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
-    extern OS_TCB *OSTCBCurPtr; 
-    
-    return (const char *)OSTCBCurPtr->NamePtr;
+#ifdef CMB_USING_HEAP_VERIFY
+/* the return value of heap block verify, the block address is never 0 or 1 */
+#define HEAP_BLOCK_END                 0
+#define HEAP_BLOCK_CORRUPTED           1
+
+enum {
+    HEAP_TYPE_RTT_MEM,
+    HEAP_TYPE_RTT_MEMHEAP,
+    HEAP_TYPE_FREERTOS,
+    HEAP_TYPE_UCOSII_PARTITION,
+};
+
+/* verified heap region */
+struct heap_region {
+    uint32_t type;
+    uint32_t begin;                    /* the first block address */
+    uint32_t end;                      /* the end block address, or the partition end on uC/OS-II */
+    void *object;                      /* OS heap object, e.g., struct rt_memheap */
+};
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+/* same as struct heap_mem on RT-Thread mem.c */
+struct rtt_heap_mem {
+    uint16_t magic;
+    uint16_t used;
+    uint32_t next, prev;               /* offset from the heap begin */
+};
+#define RTT_HEAP_MAGIC                 0x1ea0
+#define RTT_HEAP_MEM_SIZE              RT_ALIGN(sizeof(struct rtt_heap_mem), RT_ALIGN_SIZE)
+/* same as RT-Thread memheap.c */
+#define RTT_MEMHEAP_MAGIC              0x1ea01ea0
+#define RTT_MEMHEAP_MASK               0xfffffffe
+#define RTT_MEMHEAP_USED               0x01
+#define RTT_MEMHEAP_SIZE               RT_ALIGN(sizeof(struct rt_memheap_item), RT_ALIGN_SIZE)
 #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
-    return vTaskName();
+/* same as BlockLink_t on FreeRTOS heap_4.c and heap_5.c */
+struct freertos_block_link {
+    struct freertos_block_link *next_free;
+    size_t block_size;
+};
+#define FREERTOS_HEAP_STRUCT_SIZE      ((sizeof(struct freertos_block_link) + (portBYTE_ALIGNMENT - 1)) \
+                                        & ~portBYTE_ALIGNMENT_MASK)
+#define FREERTOS_BLOCK_ALLOCATED_BIT   ((size_t) 1 << (sizeof(size_t) * 8 - 1))
 #endif
-}
 
-#endif /* CMB_USING_OS_PLATFORM */
+static struct heap_region heap_regions[CMB_HEAP_VERIFY_REGION_NUM];
+static size_t heap_region_num = 0;
+static size_t heap_verify_region = 0;
+static uint32_t heap_verify_block = 0;
+static uint32_t heap_verify_header[2];
+static uint32_t heap_verify_stamp = 0;
+static size_t heap_verify_steps = 0;
+static uint32_t heap_corrupted_block = 0;
+#endif
 
-#ifdef CMB_USING_DUMP_STACK_INFO
+#ifdef CMB_USING_SIG_TABLE
+#define SIG_TABLE_MAGIC                0x434D4253
+/* retained over the warm reset */
+static CMB_NOINIT struct cmb_sig_table sig_table;
+static uint32_t last_signature_count = 0;
+#endif
+
+#ifdef CMB_USING_BKP_RECORD
 /**
- * dump current stack information
+ * calculate the micro-record checksum
+ *
+ * @param record micro-record
+ *
+ * @return 16 bits checksum
  */
-static void dump_stack(uint32_t stack_start_addr, size_t stack_size, uint32_t *stack_pointer) {
-    if (stack_is_overflow) {
-        if (on_thread_before_fault) {
-            cmb_println(print_info[PRINT_THREAD_STACK_OVERFLOW], stack_pointer);
-        } else {
-            cmb_println(print_info[PRINT_MAIN_STACK_OVERFLOW], stack_pointer);
-        }
-        if ((uint32_t) stack_pointer < stack_start_addr) {
-            stack_pointer = (uint32_t *) stack_start_addr;
-        } else if ((uint32_t) stack_pointer > stack_start_addr + stack_size) {
-            stack_pointer = (uint32_t *) (stack_start_addr + stack_size);
-        }
+static uint32_t bkp_record_checksum(const struct cmb_bkp_record *record) {
+    uint32_t sum = record->cause + record->pc + record->lr + record->thread + record->signature;
+
+    return (sum ^ (sum >> 16)) & 0xFFFF;
+}
+
+/**
+ * load and decode the last fault micro-record from backup registers, it will be cleared after loaded
+ */
+static void bkp_record_load(void) {
+    uint32_t header = BKP_REG(0);
+
+    if ((header >> 16) != BKP_RECORD_MAGIC) {
+        return;
     }
-    cmb_println(print_info[PRINT_THREAD_STACK_INFO]);
-    for (; (uint32_t) stack_pointer < stack_start_addr + stack_size; stack_pointer++) {
-        cmb_println("  addr: %08x    data: %08x", stack_pointer, *stack_pointer);
+
+    bkp_record.cause     = BKP_REG(1);
+    bkp_record.pc        = BKP_REG(2);
+    bkp_record.lr        = BKP_REG(3);
+    bkp_record.thread    = BKP_REG(4);
+    bkp_record.signature = BKP_REG(5);
+    /* the record will be invalid when reset on writing */
+    if ((header & 0xFFFF) == bkp_record_checksum(&bkp_record)) {
+        bkp_record_valid = true;
+        cmb_println(print_info[PRINT_BKP_RECORD], bkp_record.signature, bkp_record.pc, bkp_record.lr,
+                bkp_record.thread, bkp_record.cause);
     }
-    cmb_println("====================================");
+    BKP_REG(0) = 0;
 }
-#endif /* CMB_USING_DUMP_STACK_INFO */
 
 /**
- * backtrace function call stack
- *
- * @param buffer call stack buffer
- * @param size buffer size
- * @param sp stack pointer
+ * get the last fault micro-record which is decoded on library initialize
  *
- * @return depth
+ * @return micro-record, NULL: there is no fault before last reset
  */
-size_t cm_backtrace_call_stack(uint32_t *buffer, size_t size, uint32_t sp) {
-    uint32_t stack_start_addr = main_stack_start_addr, pc;
-    size_t depth = 0, stack_size = main_stack_size;
-    bool regs_saved_lr_is_valid = false;
+const struct cmb_bkp_record *cm_backtrace_bkp_record(void) {
+    return bkp_record_valid ? &bkp_record : NULL;
+}
+#endif /* CMB_USING_BKP_RECORD */
 
-    if (on_fault) {
-        if (!stack_is_overflow) {
-            /* first depth is PC */
-            buffer[depth++] = regs.saved.pc;
-            /* second depth is from LR, so need decrease a word to PC */
-            pc = regs.saved.lr - sizeof(size_t);
-            if ((pc >= code_start_addr) && (pc <= code_start_addr + code_size) && (depth < CMB_CALL_STACK_MAX_DEPTH)
-                    && (depth < size)) {
-                buffer[depth++] = pc;
-                regs_saved_lr_is_valid = true;
-            }
-        }
+#ifdef CMB_USING_HANG_CAPTURE
+/**
+ * check the hang record which is saved before last reset, it's only reported once
+ */
+static void hang_record_load(void) {
+    if (hang_record.magic != HANG_RECORD_MAGIC || hang_record.thread_num > CMB_HANG_THREAD_MAX_NUM
+            || hang_record.ipc_num > CMB_HANG_IPC_MAX_NUM) {
+        return;
+    }
 
-#ifdef CMB_USING_OS_PLATFORM
-        /* program is running on thread before fault */
-        if (on_thread_before_fault) {
-            get_cur_thread_stack_info(sp, &stack_start_addr, &stack_size);
-        }
-    } else {
-        /* OS environment */
-        if (cmb_get_sp() == cmb_get_psp()) {
-            get_cur_thread_stack_info(sp, &stack_start_addr, &stack_size);
-        }
-#endif /* CMB_USING_OS_PLATFORM */
+    hang_record_valid = true;
+    cmb_println(print_info[PRINT_HANG_RECORD], hang_record.signature, hang_record.thread, hang_record.thread_num,
+            hang_record.ipc_num);
+    hang_record.magic = 0;
+}
 
-    }
+/**
+ * get the hang record which is saved before last reset
+ *
+ * @return hang record, NULL: there is no hang before last reset
+ */
+const struct cmb_hang_record *cm_backtrace_hang_record(void) {
+    return hang_record_valid ? &hang_record : NULL;
+}
+#endif /* CMB_USING_HANG_CAPTURE */
 
-    if (stack_is_overflow) {
-        if (sp < stack_start_addr) {
-            sp = stack_start_addr;
-        } else if (sp > stack_start_addr + stack_size) {
-            sp = stack_start_addr + stack_size;
-        }
-    }
+#ifdef CMB_USING_TICK_SAMPLER
+/**
+ * print the tick samples which are saved before last reset, then clear them for this running
+ */
+static void tick_sampler_load(void) {
+    uint32_t i, num = tick_sampler.index;
+    const struct cmb_tick_sample *sample;
 
-    /* copy called function address */
-    for (; sp < stack_start_addr + stack_size; sp += sizeof(size_t)) {
-        /* the *sp value may be LR, so need decrease a word to PC */
-        pc = *((uint32_t *) sp) - sizeof(size_t);
-        /* the Cortex-M using thumb instruction, so the pc must be an odd number */
-        if (pc % 2 == 0) {
-            continue;
+    /* the sampler content is random after power on */
+    if (tick_sampler.magic == TICK_SAMPLER_MAGIC && num > 0) {
+        if (num > CMB_TICK_SAMPLER_SIZE) {
+            num = CMB_TICK_SAMPLER_SIZE;
         }
-        if ((pc >= code_start_addr) && (pc <= code_start_addr + code_size) && (depth < CMB_CALL_STACK_MAX_DEPTH)
-                && (depth < size)) {
-            /* the second depth function may be already saved, so need ignore repeat */
-            if ((depth == 2) && regs_saved_lr_is_valid && (pc == buffer[1])) {
-                continue;
-            }
-            buffer[depth++] = pc;
+        cmb_println(print_info[PRINT_TICK_SAMPLER_TITLE]);
+        for (i = tick_sampler.index - num; i != tick_sampler.index; i++) {
+            sample = &tick_sampler.samples[i & (CMB_TICK_SAMPLER_SIZE - 1)];
+            cmb_println(print_info[PRINT_TICK_SAMPLE], sample->pc, sample->lr, sample->thread);
         }
     }
 
-    return depth;
+    memset(&tick_sampler, 0, sizeof(tick_sampler));
+    tick_sampler.magic = TICK_SAMPLER_MAGIC;
 }
+#endif /* CMB_USING_TICK_SAMPLER */
 
+#ifdef CMB_USING_STACK_HWM
 /**
- * dump function call stack
- *
- * @param sp stack pointer
+ * paint the unused main stack by CMB_STACK_PAINT_WORD, the interrupts are locked on painting
  */
-static void print_call_stack(uint32_t sp) {
-    size_t i, cur_depth = 0;
-    uint32_t call_stack_buf[CMB_CALL_STACK_MAX_DEPTH] = {0};
-
-    cur_depth = cm_backtrace_call_stack(call_stack_buf, CMB_CALL_STACK_MAX_DEPTH, sp);
+static void main_stack_paint(void) {
+    uint32_t primask = cmb_irq_lock(), addr, end_addr = cmb_get_msp() - sizeof(size_t) * MAIN_STACK_PAINT_MARGIN;
 
-    for (i = 0; i < cur_depth; i++) {
-        sprintf(call_stack_info + i * (8 + 1), "%08lx", call_stack_buf[i]);
-        call_stack_info[i * (8 + 1) + 8] = ' ';
+    for (addr = main_stack_start_addr; addr < end_addr; addr += sizeof(size_t)) {
+        *(uint32_t *) addr = CMB_STACK_PAINT_WORD;
     }
 
-    if (cur_depth) {
-        cmb_println(print_info[PRINT_CALL_STACK_INFO], fw_name, CMB_ELF_FILE_EXTENSION_NAME, cur_depth * (8 + 1),
-                call_stack_info);
-    } else {
-        cmb_println(print_info[PRINT_CALL_STACK_ERR]);
-    }
+    cmb_irq_unlock(primask);
 }
+#endif /* CMB_USING_STACK_HWM */
 
+#if defined(CMB_USING_ALL_THREADS_BACKTRACE) || defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_STACK_CHECK)
 /**
- * backtrace for assert
+ * skip the registers which are saved by OS port software on thread switch
  *
- * @param sp the stack pointer when on assert occurred
+ * @param sp saved stack pointer of the switched out thread
+ * @param fpu_frame the hardware saved stack frame has FPU registers
+ *
+ * @return hardware saved stack frame address
  */
-void cm_backtrace_assert(uint32_t sp) {
-    CMB_ASSERT(init_ok);
+static uint32_t thread_skip_sw_frame(uint32_t sp, bool *fpu_frame) {
+    *fpu_frame = false;
 
-#ifdef CMB_USING_OS_PLATFORM
-    uint32_t cur_stack_pointer = cmb_get_sp();
+#if defined(THREAD_FPU_CONTEXT) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    /* flag, R4~R11, S16~S31 (only when flag is set) */
+    *fpu_frame = ((uint32_t *) sp)[0] != 0;
+    sp += sizeof(size_t) * (1 + 8 + (*fpu_frame ? 16 : 0));
+#elif defined(THREAD_FPU_CONTEXT) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    /* R4~R11, R14(EXC_RETURN), S16~S31 (only when EXC_RETURN bit4 is cleared) */
+    *fpu_frame = !(((uint32_t *) sp)[8] & (1UL << 4));
+    sp += sizeof(size_t) * (8 + 1 + (*fpu_frame ? 16 : 0));
+#else
+    /* R4~R11 */
+    sp += sizeof(size_t) * 8;
 #endif
 
-    cmb_println("");
-    cm_backtrace_firmware_info();
+    return sp;
+}
+#endif /* defined(CMB_USING_ALL_THREADS_BACKTRACE) || defined(CMB_USING_SWITCH_RECORDER) || ... */
+
+#if defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_HANG_CAPTURE) || defined(CMB_USING_STACK_CHECK) \
+        || defined(CMB_USING_STACK_OWNER)
+/**
+ * get the thread name by thread control block address
+ *
+ * @param id thread ID
+ *
+ * @return thread name, NULL: the thread has no name
+ */
+static const char *get_thread_name(uint32_t id) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    return ((struct rt_thread *) id)->name;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+#if OS_TASK_NAME_SIZE > 0 || OS_TASK_NAME_EN > 0
+    return (const char *) ((OS_TCB *) id)->OSTCBTaskName;
+#else
+    return NULL;
+#endif /* OS_TASK_NAME_SIZE > 0 || OS_TASK_NAME_EN > 0 */
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    return (const char *) ((OS_TCB *) id)->NamePtr;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    return pcTaskGetName((TaskHandle_t) id);
+#endif
+}
+#endif /* defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_HANG_CAPTURE) || ... */
+
+#ifdef CMB_USING_MPU_STACK_GUARD
+/**
+ * set the guard region on the stack bottom
+ *
+ * @param region MPU region number
+ * @param stack_start_addr stack start address
+ */
+static void mpu_stack_guard_set(uint32_t region, uint32_t stack_start_addr) {
+    uint32_t size = 0;
+
+    /* the region size is 2^(SIZE + 1) */
+    while ((2UL << size) < CMB_MPU_STACK_GUARD_SIZE) {
+        size++;
+    }
+
+    CMB_MPU_RBAR = MPU_STACK_GUARD_BASE(stack_start_addr) | MPU_RBAR_VALID | region;
+    CMB_MPU_RASR = MPU_RASR_GUARD_ATTR | (size << 1);
+}
+
+/**
+ * enable the main stack guard and thread stack guard, the MPU is enabled with default memory map when it is disabled
+ */
+static void mpu_stack_guard_init(void) {
+    mpu_stack_guard_set(CMB_MPU_MAIN_GUARD_REGION, main_stack_start_addr);
+#ifdef CMB_USING_OS_PLATFORM
+    /* the thread guard is overlapped with the main guard until the first context switch */
+    mpu_stack_guard_set(CMB_MPU_THREAD_GUARD_REGION, main_stack_start_addr);
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    mpu_stack_guard_set(CMB_MPU_PREV_THREAD_GUARD_REGION, main_stack_start_addr);
+    mpu_prev_guard_stack_start_addr = main_stack_start_addr;
+#endif
+#endif
+    if (!(CMB_MPU_CTRL & MPU_CTRL_ENABLE)) {
+        CMB_MPU_CTRL = MPU_CTRL_PRIVDEFENA | MPU_CTRL_ENABLE;
+    }
+    cmb_dsb_isb();
+}
+
+/**
+ * check the address is on the guard region of the stack
+ *
+ * @param addr checked address
+ * @param stack_start_addr stack start address
+ *
+ * @return true: the address is on the guard region
+ */
+static bool mpu_stack_guard_hit(uint32_t addr, uint32_t stack_start_addr) {
+    uint32_t base = MPU_STACK_GUARD_BASE(stack_start_addr);
+
+    return addr >= base && addr < base + CMB_MPU_STACK_GUARD_SIZE;
+}
+
+#ifdef CMB_USING_OS_PLATFORM
+/**
+ * move the thread guard region to the switched in thread, only the region base is written because the size and
+ * attributes are same for all threads
+ *
+ * @param region MPU region number of the thread guard
+ * @param stack_start_addr stack start address of the switched in thread, 0: unknown, the guard is disabled
+ */
+static void mpu_stack_guard_switch(uint32_t region, uint32_t stack_start_addr) {
+    if (stack_start_addr == 0) {
+        /* the stack of switched out thread may be freed, so the guard is overlapped with the main guard */
+        stack_start_addr = main_stack_start_addr;
+    }
+    CMB_MPU_RBAR = MPU_STACK_GUARD_BASE(stack_start_addr) | MPU_RBAR_VALID | region;
+}
+#endif /* CMB_USING_OS_PLATFORM */
+#endif /* CMB_USING_MPU_STACK_GUARD */
+
+#ifdef CMB_USING_SWITCH_RECORDER
+
+/**
+ * get the PC of the switched out thread from its saved context
+ *
+ * @param sp saved stack pointer of the switched out thread
+ *
+ * @return PC, 0: the thread has no saved context
+ */
+static uint32_t thread_saved_pc(uint32_t sp) {
+    bool fpu_frame;
+
+    if (sp == 0) {
+        return 0;
+    }
+
+    return ((uint32_t *) thread_skip_sw_frame(sp, &fpu_frame))[6];
+}
+
+/**
+ * copy the thread name to the switch record, the old thread control block may be deleted or lost after reset
+ *
+ * @param name record name buffer, it's not terminated when the name is too long
+ * @param id thread ID
+ */
+static void switch_record_name(char *name, uint32_t id) {
+    const char *thread_name = get_thread_name(id);
+
+    if (thread_name) {
+        strncpy(name, thread_name, CMB_SWITCH_RECORD_NAME_MAX);
+    } else {
+        strncpy(name, "NO_NAME", CMB_SWITCH_RECORD_NAME_MAX);
+    }
+}
+
+/**
+ * append a context switch record, the switch hooks are never nested, so it's lock-free
+ *
+ * @param from the switched out thread ID
+ * @param to the switched in thread ID
+ * @param pc the switched out thread PC, 0: unknown
+ */
+static void switch_record(uint32_t from, uint32_t to, uint32_t pc) {
+    struct cmb_switch_record *record;
+
+    if (from == to || switch_recorder.magic != SWITCH_RECORDER_MAGIC) {
+        return;
+    }
+
+    record = &switch_recorder.records[switch_recorder.index++ & (CMB_SWITCH_RECORDER_SIZE - 1)];
+    record->timestamp = cmb_get_timestamp();
+    record->from = from;
+    record->to = to;
+    record->pc = pc;
+    switch_record_name(record->from_name, from);
+    switch_record_name(record->to_name, to);
+}
+
+/**
+ * get the context switch recorder, it's retained over the warm reset
+ *
+ * @return recorder
+ */
+const struct cmb_switch_recorder *cm_backtrace_switch_recorder(void) {
+    return &switch_recorder;
+}
+
+/**
+ * print the recorded context switches, the oldest is first
+ *
+ * @param title title print information index
+ */
+static void print_switch_recorder(int title) {
+    uint32_t i, num = switch_recorder.index;
+    const struct cmb_switch_record *record;
+
+    if (num > CMB_SWITCH_RECORDER_SIZE) {
+        num = CMB_SWITCH_RECORDER_SIZE;
+    }
+
+    cmb_println(print_info[title]);
+    for (i = switch_recorder.index - num; i != switch_recorder.index; i++) {
+        record = &switch_recorder.records[i & (CMB_SWITCH_RECORDER_SIZE - 1)];
+        cmb_println(print_info[PRINT_SWITCH_RECORD], record->timestamp, CMB_SWITCH_RECORD_NAME_MAX, record->from_name,
+                record->from, CMB_SWITCH_RECORD_NAME_MAX, record->to_name, record->to, record->pc);
+    }
+}
+
+/**
+ * print the context switches of the last boot once, then clear the recorder for this boot
+ */
+static void switch_recorder_load(void) {
+    /* the recorder content is random after power on */
+    if (switch_recorder.magic == SWITCH_RECORDER_MAGIC && switch_recorder.index > 0) {
+        print_switch_recorder(PRINT_SWITCH_RECORDER_RESET_TITLE);
+    }
+
+    memset(&switch_recorder, 0, sizeof(switch_recorder));
+    switch_recorder.magic = SWITCH_RECORDER_MAGIC;
+}
+#endif /* CMB_USING_SWITCH_RECORDER */
+
+#if defined(CMB_USING_OS_PLATFORM) && (defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_MPU_STACK_GUARD) \
+        || defined(CMB_USING_STACK_CHECK))
+#ifdef CMB_USING_STACK_CHECK
+/**
+ * check the canary words on the stack bottom of the switched thread, it's called on every context switch, so only
+ * the first CMB_STACK_CHECK_WORDS painted words are compared
+ *
+ * @param thread thread control block address
+ * @param sp saved stack pointer of the thread
+ * @param stack_start_addr stack start address, 0: unknown, the thread isn't checked
+ */
+static void stack_check(void *thread, uint32_t sp, uint32_t stack_start_addr) {
+    const uint32_t *canary;
+    size_t i;
+
+    if (!init_ok || stack_overflow_recorded || stack_start_addr == 0) {
+        return;
+    }
+
+    if (sp >= stack_start_addr) {
+        canary = (const uint32_t *) ((stack_start_addr + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1));
+        for (i = 0; i < CMB_STACK_CHECK_WORDS && canary[i] == CMB_STACK_PAINT_WORD; i++);
+        if (i == CMB_STACK_CHECK_WORDS) {
+            return;
+        }
+    }
+
+    cm_backtrace_stack_overflow(thread);
+}
+#endif /* CMB_USING_STACK_CHECK */
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+/**
+ * RT-Thread scheduler hook, it's called before the context switch, so the PC of switched out thread is only known
+ * when it's preempted on interrupt
+ *
+ * @param from the switched out thread
+ * @param to the switched in thread
+ */
+static void rtt_scheduler_hook(struct rt_thread *from, struct rt_thread *to) {
+#ifdef CMB_USING_SWITCH_RECORDER
+    uint32_t pc = 0;
+#endif
+#ifdef CMB_USING_MPU_STACK_GUARD
+    uint32_t psp;
+#endif
+
+#ifdef CMB_USING_SWITCH_RECORDER
+    if (cmb_get_sp() != cmb_get_psp()) {
+        /* the switched out thread hardware saved stack frame is on PSP */
+        pc = ((uint32_t *) cmb_get_psp())[6];
+    }
+
+    switch_record((uint32_t) from, (uint32_t) to, pc);
+#endif
+
+#ifdef CMB_USING_MPU_STACK_GUARD
+    /* the context of switched out thread is saved on PendSV after this hook, so it's still guarded by the other
+     * region until next switch. It isn't switched out yet when the PSP isn't on its stack (the pending switch on
+     * interrupt is changed), and the stack of closed thread may be freed, so its guard is released. */
+    psp = cmb_get_psp();
+    if (psp >= (uint32_t) from->stack_addr && psp <= (uint32_t) from->stack_addr + from->stack_size) {
+        if (from->stat == RT_THREAD_CLOSE) {
+            mpu_stack_guard_switch(mpu_thread_guard_region, 0);
+            mpu_prev_guard_stack_start_addr = main_stack_start_addr;
+        } else {
+            mpu_prev_guard_stack_start_addr = (uint32_t) from->stack_addr;
+        }
+        mpu_thread_guard_region = MPU_THREAD_GUARD_OTHER(mpu_thread_guard_region);
+    }
+    mpu_stack_guard_switch(mpu_thread_guard_region, (uint32_t) to->stack_addr);
+#endif
+
+#ifdef CMB_USING_STACK_CHECK
+    /* the switched out thread context isn't saved yet, so the switched in thread is checked */
+    stack_check(to, (uint32_t) to->sp, (uint32_t) to->stack_addr);
+#endif
+}
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII) || (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+/**
+ * record the context switch, move the thread stack guard and check the switched out thread stack, it should be called
+ * by OSTaskSwHook (or App_TaskSwHook)
+ */
+void cm_backtrace_task_sw_hook(void) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+#if defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_MPU_STACK_GUARD)
+    extern OS_TCB *OSTCBHighRdy;
+#endif
+#if defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_STACK_CHECK)
+    extern OS_TCB *OSTCBCur;
+#endif
+
+#ifdef CMB_USING_SWITCH_RECORDER
+    switch_record((uint32_t) OSTCBCur, (uint32_t) OSTCBHighRdy, thread_saved_pc((uint32_t) OSTCBCur->OSTCBStkPtr));
+#endif
+#ifdef CMB_USING_MPU_STACK_GUARD
+    mpu_stack_guard_switch(CMB_MPU_THREAD_GUARD_REGION, (uint32_t) OSTCBHighRdy->OSTCBStkBottom);
+#endif
+#ifdef CMB_USING_STACK_CHECK
+    /* the switched out task context was saved by OSPendSV, the task which is created by OSTaskCreate has no stack
+     * bottom, and the stack which isn't cleared on creating has no canary */
+    if (OSTCBCur->OSTCBOpt & OS_TASK_OPT_STK_CLR) {
+        stack_check(OSTCBCur, (uint32_t) OSTCBCur->OSTCBStkPtr, (uint32_t) OSTCBCur->OSTCBStkBottom);
+    }
+#endif
+#else
+#if defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_MPU_STACK_GUARD)
+    extern OS_TCB *OSTCBHighRdyPtr;
+#endif
+#if defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_STACK_CHECK)
+    extern OS_TCB *OSTCBCurPtr;
+#endif
+
+#ifdef CMB_USING_SWITCH_RECORDER
+    switch_record((uint32_t) OSTCBCurPtr, (uint32_t) OSTCBHighRdyPtr, thread_saved_pc((uint32_t) OSTCBCurPtr->StkPtr));
+#endif
+#ifdef CMB_USING_MPU_STACK_GUARD
+    mpu_stack_guard_switch(CMB_MPU_THREAD_GUARD_REGION, (uint32_t) OSTCBHighRdyPtr->StkBasePtr);
+#endif
+#ifdef CMB_USING_STACK_CHECK
+    /* the switched out task context was saved by OS_CPU_PendSVHandler, the stack which isn't cleared on creating has
+     * no canary */
+    if (OSTCBCurPtr->Opt & OS_OPT_TASK_STK_CLR) {
+        stack_check(OSTCBCurPtr, (uint32_t) OSTCBCurPtr->StkPtr, (uint32_t) OSTCBCurPtr->StkBasePtr);
+    }
+#endif
+#endif
+}
+#endif /* (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) */
+#endif /* defined(CMB_USING_OS_PLATFORM) && (defined(CMB_USING_SWITCH_RECORDER) || ...) */
+
+#ifdef CMB_USING_IRQ_RECORDER
+/**
+ * append an interrupt entry record, it's called by the generated vector table trampoline before the real handler.
+ * the interrupts may be nested, so the record index is reserved with interrupts locked.
+ *
+ * @param exc_return the EXC_RETURN value on LR of the handler
+ * @param msp the MSP on handler entry
+ * @param exception IPSR exception number
+ */
+void cm_backtrace_irq_record(uint32_t exc_return, uint32_t msp, uint32_t exception) {
+    struct cmb_irq_record *record;
+    uint32_t primask, index;
+
+    if (irq_recorder.magic != IRQ_RECORDER_MAGIC) {
+        return;
+    }
+
+    primask = cmb_irq_lock();
+    index = irq_recorder.index++;
+    cmb_irq_unlock(primask);
+
+    record = &irq_recorder.records[index & (CMB_IRQ_RECORDER_SIZE - 1)];
+    record->timestamp = cmb_get_timestamp();
+    record->exception = exception;
+    /* the preempted context hardware saved stack frame is on PSP when EXC_RETURN bit2 is set */
+    record->pc = ((uint32_t *) ((exc_return & (1UL << 2)) ? cmb_get_psp() : msp))[6];
+}
+
+/**
+ * get the interrupt entry recorder, it's retained over the warm reset
+ *
+ * @return recorder
+ */
+const struct cmb_irq_recorder *cm_backtrace_irq_recorder(void) {
+    return &irq_recorder;
+}
+
+/**
+ * print the recorded interrupt entries, the oldest is first
+ *
+ * @param title title print information index
+ */
+static void print_irq_recorder(int title) {
+    uint32_t i, num = irq_recorder.index;
+    const struct cmb_irq_record *record;
+
+    if (num > CMB_IRQ_RECORDER_SIZE) {
+        num = CMB_IRQ_RECORDER_SIZE;
+    }
+
+    cmb_println(print_info[title]);
+    for (i = irq_recorder.index - num; i != irq_recorder.index; i++) {
+        record = &irq_recorder.records[i & (CMB_IRQ_RECORDER_SIZE - 1)];
+        cmb_println(print_info[PRINT_IRQ_RECORD], record->timestamp, record->exception, (int) record->exception - 16,
+                record->pc);
+    }
+}
+
+/**
+ * print the interrupt entries of the last boot once, then clear the recorder for this boot
+ */
+static void irq_recorder_load(void) {
+    /* the recorder content is random after power on */
+    if (irq_recorder.magic == IRQ_RECORDER_MAGIC && irq_recorder.index > 0) {
+        print_irq_recorder(PRINT_IRQ_RECORDER_RESET_TITLE);
+    }
+
+    memset(&irq_recorder, 0, sizeof(irq_recorder));
+    irq_recorder.magic = IRQ_RECORDER_MAGIC;
+}
+#endif /* CMB_USING_IRQ_RECORDER */
+
+#ifdef CMB_USING_IPC_PROFILER
+/**
+ * RT-Thread trytake hook, it's called on the start of rt_sem_take and rt_mutex_take. When the object is not available,
+ * the current thread is going to block, so it's saved as a waiter with the holder and start timestamp.
+ * The waiter which is left by a timeout take (the take hook isn't called) is reused on the next take of same thread.
+ *
+ * @param object IPC object
+ */
+static void ipc_trytake_hook(struct rt_object *object) {
+    uint32_t thread = (uint32_t) rt_thread_self(), holder = 0, primask;
+    rt_uint8_t type = object->type & ~RT_Object_Class_Static;
+    struct ipc_waiter *waiter = NULL;
+    bool blocked = false;
+    size_t i;
+
+    if (rt_interrupt_get_nest() != 0) {
+        return;
+    }
+
+#ifdef RT_USING_MUTEX
+    if (type == RT_Object_Class_Mutex) {
+        struct rt_mutex *mutex = (struct rt_mutex *) object;
+        blocked = mutex->value == 0 && mutex->owner != (struct rt_thread *) thread;
+        holder = (uint32_t) mutex->owner;
+    }
+#endif
+#ifdef RT_USING_SEMAPHORE
+    if (type == RT_Object_Class_Semaphore) {
+        blocked = ((struct rt_semaphore *) object)->value == 0;
+    }
+#endif
+
+    primask = cmb_irq_lock();
+    for (i = 0; i < CMB_IPC_PROFILER_WAITER_NUM; i++) {
+        if (ipc_waiters[i].thread == thread) {
+            waiter = &ipc_waiters[i];
+            break;
+        } else if (ipc_waiters[i].thread == 0 && waiter == NULL) {
+            waiter = &ipc_waiters[i];
+        }
+    }
+    if (!blocked) {
+        /* release the waiter which is left by the last timeout take */
+        if (waiter && waiter->thread == thread) {
+            waiter->thread = 0;
+        }
+    } else if (waiter) {
+        waiter->thread = thread;
+        waiter->object = (uint32_t) object;
+        waiter->holder = holder;
+        waiter->start = cmb_get_timestamp();
+        strncpy(waiter->holder_name, holder ? ((struct rt_thread *) holder)->name : "-", CMB_IPC_PROFILER_NAME_MAX);
+    } else {
+        ipc_contention_dropped++;
+    }
+    cmb_irq_unlock(primask);
+}
+
+/**
+ * RT-Thread take hook, it's called after rt_sem_take and rt_mutex_take is successful. The blocking take of current
+ * thread is counted by the waiter call stack and object on a fixed size open addressing hash table. The object and
+ * holder names are copied to the record, so the dump doesn't access the deleted objects.
+ *
+ * @param object IPC object
+ */
+static void ipc_take_hook(struct rt_object *object) {
+    /* the first word is object, the waiter call stack is followed */
+    uint32_t thread = (uint32_t) rt_thread_self(), key[1 + CMB_IPC_PROFILER_DEPTH], hash, index, wait, holder, primask;
+    char holder_name[CMB_IPC_PROFILER_NAME_MAX];
+    struct ipc_waiter *waiter = NULL;
+    struct cmb_ipc_contention *record;
+    size_t i, depth;
+
+    if (rt_interrupt_get_nest() != 0) {
+        return;
+    }
+
+    /* the waiter is only changed by its own thread, so it's found without lock */
+    for (i = 0; i < CMB_IPC_PROFILER_WAITER_NUM; i++) {
+        if (ipc_waiters[i].thread == thread) {
+            waiter = &ipc_waiters[i];
+            break;
+        }
+    }
+    if (waiter == NULL) {
+        return;
+    }
+    if (waiter->object != (uint32_t) object) {
+        waiter->thread = 0;
+        return;
+    }
+    wait = cmb_get_timestamp() - waiter->start;
+    holder = waiter->holder;
+    memcpy(holder_name, waiter->holder_name, CMB_IPC_PROFILER_NAME_MAX);
+    waiter->thread = 0;
+
+    memset(key, 0, sizeof(key));
+    key[0] = (uint32_t) object;
+    /* the scan starts above the key buffer, so the stale words of this hook frame aren't taken as return address */
+    depth = cm_backtrace_call_stack(key + 1, CMB_IPC_PROFILER_DEPTH, (uint32_t) (key + 1 + CMB_IPC_PROFILER_DEPTH));
+    /* the hash 0 is used by empty record */
+    hash = cm_backtrace_stack_hash(key, 1 + depth);
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    primask = cmb_irq_lock();
+    for (i = 0, index = hash; i < CMB_IPC_PROFILER_TABLE_SIZE; i++, index++) {
+        record = &ipc_contentions[index & (CMB_IPC_PROFILER_TABLE_SIZE - 1)];
+        if (record->hash == hash) {
+            break;
+        } else if (record->hash == 0) {
+            memset(record, 0, sizeof(struct cmb_ipc_contention));
+            record->hash = hash;
+            record->object = (uint32_t) object;
+            strncpy(record->object_name, object->name, CMB_IPC_PROFILER_NAME_MAX);
+            record->depth = depth;
+            memcpy(record->call_stack, key + 1, depth * sizeof(uint32_t));
+            ipc_contention_num++;
+            break;
+        }
+    }
+    if (i < CMB_IPC_PROFILER_TABLE_SIZE) {
+        record->holder = holder;
+        memcpy(record->holder_name, holder_name, CMB_IPC_PROFILER_NAME_MAX);
+        record->count++;
+        record->total_wait += wait;
+        if (wait > record->max_wait) {
+            record->max_wait = wait;
+        }
+    } else {
+        /* the table is full */
+        ipc_contention_dropped++;
+    }
+    cmb_irq_unlock(primask);
+}
+#endif /* CMB_USING_IPC_PROFILER */
+
+#ifdef CMB_USING_STACK_OWNER
+/**
+ * find the stack owner of the thread on index, the interrupts must be locked
+ *
+ * @param thread thread ID, 0: main stack
+ *
+ * @return index, stack_owner_num: not found
+ */
+static size_t stack_owner_index(uint32_t thread) {
+    size_t i;
+
+    for (i = 0; i < stack_owner_num && stack_owners[i].thread != thread; i++);
+
+    return i;
+}
+
+/**
+ * remove the stack owner of the thread from index
+ *
+ * @param thread thread ID, 0: main stack
+ */
+static void stack_owner_remove(uint32_t thread) {
+    uint32_t primask = cmb_irq_lock();
+    size_t i = stack_owner_index(thread);
+
+    if (i < stack_owner_num) {
+        stack_owner_num--;
+        memmove(&stack_owners[i], &stack_owners[i + 1], (stack_owner_num - i) * sizeof(struct cmb_stack_owner));
+    }
+
+    cmb_irq_unlock(primask);
+}
+
+/**
+ * insert the stack owner to index by start address, the old stack of the thread is replaced
+ *
+ * @param thread thread ID, 0: main stack
+ * @param stack_start_addr stack start address
+ * @param stack_size stack size
+ */
+static void stack_owner_insert(uint32_t thread, uint32_t stack_start_addr, size_t stack_size) {
+    uint32_t primask = cmb_irq_lock();
+    size_t i = stack_owner_index(thread);
+
+    if (i < stack_owner_num) {
+        stack_owner_num--;
+        memmove(&stack_owners[i], &stack_owners[i + 1], (stack_owner_num - i) * sizeof(struct cmb_stack_owner));
+    }
+
+    /* the new threads are not indexed when the index is full */
+    if (stack_size && stack_owner_num < sizeof(stack_owners) / sizeof(stack_owners[0])) {
+        for (i = stack_owner_num; i > 0 && stack_owners[i - 1].start_addr > stack_start_addr; i--) {
+            stack_owners[i] = stack_owners[i - 1];
+        }
+        stack_owners[i].start_addr = stack_start_addr;
+        stack_owners[i].end_addr = stack_start_addr + stack_size;
+        stack_owners[i].thread = thread;
+        stack_owner_num++;
+    } else if (stack_size) {
+        stack_owner_dropped++;
+    }
+
+    cmb_irq_unlock(primask);
+}
+
+/**
+ * insert the walked thread to index on library initialize
+ *
+ * @param thread thread information
+ * @param arg unused
+ */
+static void stack_owner_insert_thread(const struct cmb_thread_info *thread, void *arg) {
+    stack_owner_insert(thread->id, thread->stack_start_addr, thread->stack_size);
+}
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+/**
+ * RT-Thread object attach hook, the thread object is attached before its stack is initialized by _rt_thread_init,
+ * and the thread timer is initialized on the end of _rt_thread_init, so the thread is inserted to index when its
+ * timer is attached
+ *
+ * @param object the attached object
+ */
+static void stack_owner_attach_hook(struct rt_object *object) {
+    struct rt_object_information *information;
+    struct rt_list_node *node;
+    struct rt_thread *thread;
+    uint32_t primask;
+
+    if ((object->type & ~RT_Object_Class_Static) != RT_Object_Class_Timer) {
+        return;
+    }
+
+    /* it's the thread timer when it's on a thread object, the new thread is on the head of the thread list */
+    information = rt_object_get_information(RT_Object_Class_Thread);
+    primask = cmb_irq_lock();
+    for (node = information->object_list.next; node != &information->object_list; node = node->next) {
+        thread = rt_list_entry(node, struct rt_thread, list);
+        if (&thread->thread_timer == (struct rt_timer *) object) {
+            stack_owner_insert((uint32_t) thread, (uint32_t) thread->stack_addr, thread->stack_size);
+            break;
+        }
+    }
+    cmb_irq_unlock(primask);
+}
+
+/**
+ * RT-Thread object detach hook, it's called when the thread is detached or deleted
+ *
+ * @param object the detached object
+ */
+static void stack_owner_detach_hook(struct rt_object *object) {
+    if ((object->type & ~RT_Object_Class_Static) != RT_Object_Class_Thread) {
+        return;
+    }
+
+    stack_owner_remove((uint32_t) object);
+}
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII) || (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+/**
+ * insert the created task stack to the stack owner index, it should be called by OSTaskCreateHook (or
+ * App_TaskCreateHook)
+ *
+ * @param tcb the created task control block
+ */
+void cm_backtrace_task_create_hook(void *tcb) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    stack_owner_insert((uint32_t) tcb, (uint32_t) ((OS_TCB *) tcb)->OSTCBStkBottom,
+            ((OS_TCB *) tcb)->OSTCBStkSize * sizeof(OS_STK));
+#else
+    stack_owner_insert((uint32_t) tcb, (uint32_t) ((OS_TCB *) tcb)->StkBasePtr,
+            ((OS_TCB *) tcb)->StkSize * sizeof(CPU_STK_SIZE));
+#endif
+}
+
+/**
+ * remove the deleted task stack from the stack owner index, it should be called by OSTaskDelHook (or App_TaskDelHook)
+ *
+ * @param tcb the deleted task control block
+ */
+void cm_backtrace_task_del_hook(void *tcb) {
+    stack_owner_remove((uint32_t) tcb);
+}
+#endif /* (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) */
+
+/**
+ * find the stack owner of the address by binary search on the sorted stack owner index, the owner is copied with
+ * interrupt disabled, so the index can be modified by the create or delete hook during the search
+ *
+ * @param addr address, e.g., stack pointer, register value or fault address
+ * @param owner the found stack owner
+ *
+ * @return true: found, false: the address isn't on any stack
+ */
+bool cm_backtrace_stack_owner(uint32_t addr, struct cmb_stack_owner *owner) {
+    size_t low = 0, high, mid;
+    uint32_t primask;
+    bool found = false;
+
+    primask = cmb_irq_lock();
+    /* find the last stack owner which start address is less than or equal to the address */
+    high = stack_owner_num;
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (stack_owners[mid].start_addr <= addr) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low != 0 && addr < stack_owners[low - 1].end_addr) {
+        *owner = stack_owners[low - 1];
+        found = true;
+    }
+    cmb_irq_unlock(primask);
+
+    return found;
+}
+#endif /* CMB_USING_STACK_OWNER */
+
+#if defined(CMB_USING_HEAP_TRACKER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+#ifdef RT_USING_HEAP
+static void rtt_malloc_hook(void *ptr, rt_uint32_t size) {
+    cm_backtrace_heap_alloc(ptr, size);
+}
+
+static void rtt_free_hook(void *ptr) {
+    cm_backtrace_heap_free(ptr);
+}
+#endif /* RT_USING_HEAP */
+
+#ifdef RT_USING_MEMPOOL
+static void rtt_mp_alloc_hook(struct rt_mempool *mp, void *block) {
+    cm_backtrace_heap_alloc(block, mp->block_size);
+}
+
+static void rtt_mp_free_hook(struct rt_mempool *mp, void *block) {
+    cm_backtrace_heap_free(block);
+}
+#endif /* RT_USING_MEMPOOL */
+#endif /* defined(CMB_USING_HEAP_TRACKER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) */
+
+#if defined(CMB_USING_HEAP_VERIFY) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+static void rtt_idle_hook(void) {
+    cm_backtrace_heap_verify();
+}
+#endif
+
+/**
+ * library initialize
+ */
+void cm_backtrace_init(const char *firmware_name, const char *hardware_ver, const char *software_ver) {
+    strncpy(fw_name, firmware_name, CMB_NAME_MAX);
+    strncpy(hw_ver, hardware_ver, CMB_NAME_MAX);
+    strncpy(sw_ver, software_ver, CMB_NAME_MAX);
+
+#if defined(__CC_ARM)
+    main_stack_start_addr = (uint32_t)&CSTACK_BLOCK_START(CMB_CSTACK_BLOCK_NAME);
+    main_stack_size = (uint32_t)&CSTACK_BLOCK_END(CMB_CSTACK_BLOCK_NAME) - main_stack_start_addr;
+    code_start_addr = (uint32_t)&CODE_SECTION_START(CMB_CODE_SECTION_NAME);
+    code_size = (uint32_t)&CODE_SECTION_END(CMB_CODE_SECTION_NAME) - code_start_addr;
+#elif defined(__ICCARM__)
+    main_stack_start_addr = (uint32_t)__section_begin(CMB_CSTACK_BLOCK_NAME);
+    main_stack_size = (uint32_t)__section_end(CMB_CSTACK_BLOCK_NAME) - main_stack_start_addr;
+    code_start_addr = (uint32_t)__section_begin(CMB_CODE_SECTION_NAME);
+    code_size = (uint32_t)__section_end(CMB_CODE_SECTION_NAME) - code_start_addr;
+#elif defined(__GNUC__)
+    main_stack_start_addr = (uint32_t)(&CMB_CSTACK_BLOCK_START);
+    main_stack_size = (uint32_t)(&CMB_CSTACK_BLOCK_END) - main_stack_start_addr;
+    code_start_addr = (uint32_t)(&CMB_CODE_SECTION_START);
+    code_size = (uint32_t)(&CMB_CODE_SECTION_END) - code_start_addr;
+#else
+    #error "not supported compiler"
+#endif
+
+#ifdef CMB_USING_BKP_RECORD
+    bkp_record_load();
+#endif
+
+#ifdef CMB_USING_HANG_CAPTURE
+    hang_record_load();
+#endif
+
+#ifdef CMB_USING_TICK_SAMPLER
+    tick_sampler_load();
+#endif
+
+#ifdef CMB_USING_CONFIGURABLE_FAULT
+    /* the configurable faults don't escalate to hard fault, so the higher priority interrupts still can be run */
+    CMB_SYSHND_PRI1 = (CMB_SYSHND_PRI1 & 0xFF000000) | (CMB_CONFIGURABLE_FAULT_PRIORITY << 16)
+            | (CMB_CONFIGURABLE_FAULT_PRIORITY << 8) | CMB_CONFIGURABLE_FAULT_PRIORITY;
+    /* enable MemManage, BusFault and UsageFault handler */
+    CMB_SYSHND_CTRL |= (1UL << 16) | (1UL << 17) | (1UL << 18);
+#endif
+
+#ifdef CMB_DEFERRED_REPORT_USING_PENDSV
+    /* the deferred report must be printed on the lowest priority */
+    CMB_SYSHND_PRI3 |= 0x00FF0000;
+#endif
+
+#ifdef CMB_USING_STACK_HWM
+    main_stack_paint();
+#endif
+
+#ifdef CMB_USING_MPU_STACK_GUARD
+    /* it's enabled after the main stack is painted */
+    mpu_stack_guard_init();
+#endif
+
+#if (defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_IRQ_RECORDER) || defined(CMB_USING_IPC_PROFILER) \
+        || defined(CMB_USING_PHASE_TIMING)) && (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+    /* enable the DWT cycle counter for default timestamp */
+    CMB_DEMCR |= (1UL << 24);
+    CMB_DWT_CTRL |= (1UL << 0);
+#endif
+
+#ifdef CMB_USING_IRQ_RECORDER
+    irq_recorder_load();
+#endif
+
+#ifdef CMB_USING_SWITCH_RECORDER
+    switch_recorder_load();
+#endif
+
+#if defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) \
+        && (defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_MPU_STACK_GUARD) || defined(CMB_USING_STACK_CHECK))
+    rt_scheduler_sethook(rtt_scheduler_hook);
+#endif
+
+#ifdef CMB_USING_STACK_OWNER
+    stack_owner_insert(0, main_stack_start_addr, main_stack_size);
+    /* the threads which are created before library initialize */
+    cm_backtrace_foreach_thread(stack_owner_insert_thread, NULL);
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    rt_object_attach_sethook(stack_owner_attach_hook);
+    rt_object_detach_sethook(stack_owner_detach_hook);
+#endif
+#endif
+
+#ifdef CMB_USING_IPC_PROFILER
+    rt_object_trytake_sethook(ipc_trytake_hook);
+    rt_object_take_sethook(ipc_take_hook);
+#endif
+
+#if defined(CMB_USING_HEAP_TRACKER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+#ifdef RT_USING_HEAP
+    rt_malloc_sethook(rtt_malloc_hook);
+    rt_free_sethook(rtt_free_hook);
+#endif
+#ifdef RT_USING_MEMPOOL
+    rt_mp_alloc_sethook(rtt_mp_alloc_hook);
+    rt_mp_free_sethook(rtt_mp_free_hook);
+#endif
+#endif /* defined(CMB_USING_HEAP_TRACKER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) */
+
+#if defined(CMB_USING_HEAP_VERIFY) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    /* the RT-Thread has only one idle hook, so the application idle hook is replaced */
+    rt_thread_idle_sethook(rtt_idle_hook);
+#endif
+
+#ifdef CMB_USING_SOFT_ASSERT
+    {
+        size_t i;
+
+        /* each record is free on first lap */
+        for (i = 0; i < CMB_SOFT_ASSERT_RING_SIZE; i++) {
+            soft_assert_ring[i].seq = i;
+        }
+    }
+#endif
+
+#ifdef CMB_USING_SIG_TABLE
+    /* the table content is random after power on */
+    if (sig_table.magic != SIG_TABLE_MAGIC || sig_table.num > CMB_SIG_TABLE_SIZE) {
+        cm_backtrace_sig_table_clear();
+    }
+#endif
+
+    init_ok = true;
+}
+
+/**
+ * print firmware information, such as: firmware name, hardware version, software version
+ */
+void cm_backtrace_firmware_info(void) {
+    cmb_println(print_info[PRINT_FIRMWARE_INFO], fw_name, hw_ver, sw_ver);
+}
+
+#if defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+/**
+ * cache the task stack bounds and name, it should be called by traceTASK_CREATE(pxNewTCB)
+ * @note it uses the task number, so the vTaskSetTaskNumber can't be used by user
+ *
+ * @param task the new task handle
+ */
+void cm_backtrace_freertos_task_create(void *task) {
+    TaskStatus_t status;
+    size_t i;
+
+    for (i = 0; i < CMB_FREERTOS_TASK_MAX_NUM && freertos_tasks[i].id; i++);
+    if (i == CMB_FREERTOS_TASK_MAX_NUM) {
+        /* the task stack bounds is unknown when the cache is full */
+        vTaskSetTaskNumber(task, 0);
+        return;
+    }
+
+    /* the eCurrentState is read by vTaskGetInfo before it is set */
+    status.eCurrentState = eReady;
+    vTaskGetInfo(task, &status, pdFALSE, eReady);
+
+    freertos_tasks[i].name = status.pcTaskName;
+    freertos_tasks[i].id = (uint32_t) task;
+    freertos_tasks[i].stack_start_addr = (uint32_t) status.pxStackBase;
+    /* the pxTopOfStack is the first member of TCB, it's the initial top of stack now */
+    freertos_tasks[i].stack_size = *(uint32_t *) task + sizeof(size_t) * FREERTOS_INIT_STACK_WORDS
+            - freertos_tasks[i].stack_start_addr;
+    vTaskSetTaskNumber(task, i + 1);
+
+#ifdef CMB_USING_STACK_OWNER
+    stack_owner_insert(freertos_tasks[i].id, freertos_tasks[i].stack_start_addr, freertos_tasks[i].stack_size);
+#endif
+}
+
+/**
+ * get the cached task stack bounds
+ *
+ * @param task task handle
+ *
+ * @return NULL: the task isn't cached
+ */
+static struct cmb_thread_info *freertos_task_find(void *task) {
+    UBaseType_t number = uxTaskGetTaskNumber(task);
+
+    if (number == 0 || number > CMB_FREERTOS_TASK_MAX_NUM || freertos_tasks[number - 1].id != (uint32_t) task) {
+        return NULL;
+    }
+
+    return &freertos_tasks[number - 1];
+}
+
+/**
+ * release the cached task stack bounds, it should be called by traceTASK_DELETE(pxTCB)
+ *
+ * @param task the deleted task handle
+ */
+void cm_backtrace_freertos_task_delete(void *task) {
+    struct cmb_thread_info *info = freertos_task_find(task);
+
+    if (info) {
+        info->id = 0;
+    }
+
+#ifdef CMB_USING_STACK_OWNER
+    stack_owner_remove((uint32_t) task);
+#endif
+}
+
+/**
+ * update the current task stack bounds, it should be called by traceTASK_SWITCHED_IN() with pxCurrentTCB
+ *
+ * @param task the switched in task handle
+ */
+void cm_backtrace_freertos_task_switched_in(void *task) {
+#ifdef CMB_USING_SWITCH_RECORDER
+    static void *last_task = NULL;
+
+    /* the pxTopOfStack is the first member of TCB, the switched out task context was saved */
+    if (last_task) {
+        switch_record((uint32_t) last_task, (uint32_t) task, thread_saved_pc(*(uint32_t *) last_task));
+    }
+    last_task = task;
+#endif
+
+#ifdef CMB_USING_STACK_CHECK
+    /* the pxTopOfStack is the first member of TCB, the switched out task context was saved */
+    if (freertos_cur_task && freertos_cur_task->id) {
+        stack_check((void *) freertos_cur_task->id, *(uint32_t *) freertos_cur_task->id,
+                freertos_cur_task->stack_start_addr);
+    }
+#endif
+
+    freertos_cur_task = freertos_task_find(task);
+
+#ifdef CMB_USING_MPU_STACK_GUARD
+    mpu_stack_guard_switch(CMB_MPU_THREAD_GUARD_REGION,
+            freertos_cur_task ? freertos_cur_task->stack_start_addr : 0);
+#endif
+}
+#endif /* defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS) */
+
+#ifdef CMB_USING_OS_PLATFORM
+/**
+ * Get current thread stack information
+ *
+ * @param sp stack current pointer
+ * @param start_addr stack start address
+ * @param size stack size
+ */
+static void get_cur_thread_stack_info(uint32_t sp, uint32_t *start_addr, size_t *size) {
+    CMB_ASSERT(start_addr);
+    CMB_ASSERT(size);
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    *start_addr = (uint32_t) rt_thread_self()->stack_addr;
+    *size = rt_thread_self()->stack_size;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    extern OS_TCB *OSTCBCur;
+
+    *start_addr = (uint32_t) OSTCBCur->OSTCBStkBottom;
+    *size = OSTCBCur->OSTCBStkSize * sizeof(OS_STK);
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    extern OS_TCB *OSTCBCurPtr; 
+    
+    *start_addr = (uint32_t) OSTCBCurPtr->StkBasePtr;
+    *size = OSTCBCurPtr->StkSize * sizeof(CPU_STK_SIZE);
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    if (freertos_cur_task) {
+        *start_addr = freertos_cur_task->stack_start_addr;
+        *size = freertos_cur_task->stack_size;
+    } else {
+        /* the task isn't cached and its stack top is unknown, so only the hardware saved stack frame is in bounds,
+         * the stack over it isn't scanned because it may be out of the task stack */
+        *start_addr = sp;
+        *size = sizeof(size_t) * FREERTOS_FRAME_WORDS;
+    }
+#endif
+}
+
+/**
+ * Get current thread name
+ */
+static const char *get_cur_thread_name(void) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    return rt_thread_self()->name;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    extern OS_TCB *OSTCBCur;
+
+#if OS_TASK_NAME_SIZE > 0 || OS_TASK_NAME_EN > 0
+        return (const char *)OSTCBCur->OSTCBTaskName;
+#else
+        return NULL;
+#endif /* OS_TASK_NAME_SIZE > 0 || OS_TASK_NAME_EN > 0 */
+
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    extern OS_TCB *OSTCBCurPtr; 
+    
+    return (const char *)OSTCBCurPtr->NamePtr;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    return pcTaskGetName(NULL);
+#endif
+}
+
+#if defined(CMB_USING_BKP_RECORD) || defined(CMB_USING_ALL_THREADS_BACKTRACE) || defined(CMB_USING_TICK_SAMPLER) \
+        || defined(CMB_USING_STACK_OWNER)
+/**
+ * Get current thread ID, it is the thread control block address
+ */
+static uint32_t get_cur_thread_id(void) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    return (uint32_t) rt_thread_self();
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    extern OS_TCB *OSTCBCur;
+
+    return (uint32_t) OSTCBCur;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    extern OS_TCB *OSTCBCurPtr;
+
+    return (uint32_t) OSTCBCurPtr;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    extern void * volatile pxCurrentTCB;
+
+    return (uint32_t) pxCurrentTCB;
+#endif
+}
+#endif /* defined(CMB_USING_BKP_RECORD) || defined(CMB_USING_ALL_THREADS_BACKTRACE) || ... */
+
+#endif /* CMB_USING_OS_PLATFORM */
+
+#ifdef CMB_USING_DUMP_STACK_INFO
+/**
+ * dump current stack information
+ */
+static void dump_stack(uint32_t stack_start_addr, size_t stack_size, uint32_t *stack_pointer) {
+    size_t i;
+
+    if (stack_is_overflow) {
+        if ((uint32_t) stack_pointer < stack_start_addr) {
+            stack_pointer = (uint32_t *) stack_start_addr;
+        } else if ((uint32_t) stack_pointer > stack_start_addr + stack_size) {
+            stack_pointer = (uint32_t *) (stack_start_addr + stack_size);
+        }
+    }
+    cmb_println(print_info[PRINT_THREAD_STACK_INFO]);
+    for (i = 0; (uint32_t) stack_pointer < stack_start_addr + stack_size; stack_pointer++, i++) {
+        cmb_println("  addr: %08x    data: %08x", stack_pointer, *stack_pointer);
+        /* the bulk stack data may be printed for a long time */
+        if (i % DUMP_STACK_FEED_WORDS == DUMP_STACK_FEED_WORDS - 1) {
+            cmb_wdt_feed();
+        }
+    }
+    cmb_println("====================================");
+}
+#endif /* CMB_USING_DUMP_STACK_INFO */
+
+/**
+ * copy the called function address on stack
+ *
+ * @param buffer call stack buffer
+ * @param depth the depth which is already saved on buffer
+ * @param size buffer size
+ * @param sp stack pointer
+ * @param stack_end_addr stack end address
+ * @param regs_saved_lr_is_valid the second depth is already saved from LR
+ *
+ * @return depth
+ */
+static size_t scan_call_stack(uint32_t *buffer, size_t depth, size_t size, uint32_t sp, uint32_t stack_end_addr,
+        bool regs_saved_lr_is_valid) {
+    uint32_t pc;
+
+    for (; sp < stack_end_addr && depth < CMB_CALL_STACK_MAX_DEPTH && depth < size; sp += sizeof(size_t)) {
+        /* the *sp value may be LR, so need decrease a word to PC */
+        pc = *((uint32_t *) sp) - sizeof(size_t);
+        /* the Cortex-M using thumb instruction, so the pc must be an odd number */
+        if (pc % 2 == 0) {
+            continue;
+        }
+        if ((pc >= code_start_addr) && (pc <= code_start_addr + code_size)) {
+            /* the second depth function may be already saved, so need ignore repeat */
+            if ((depth == 2) && regs_saved_lr_is_valid && (pc == buffer[1])) {
+                continue;
+            }
+            buffer[depth++] = pc;
+        }
+    }
+
+    return depth;
+}
+
+#ifdef CMB_USING_SHADOW_STACK
+/* the shadow call stack of main stack, it's used by bare metal, interrupts and the code before the OS is started */
+static struct cmb_shadow_stack main_shadow_stack = { 0 };
+
+#ifdef CMB_USING_OS_PLATFORM
+/**
+ * get the shadow call stack of thread, it's saved on thread local storage
+ *
+ * @param thread thread control block
+ *
+ * @return shadow call stack, NULL: the thread has no shadow call stack
+ */
+__attribute__((no_instrument_function))
+static struct cmb_shadow_stack *shadow_stack_of_thread(void *thread) {
+    if (thread == NULL) {
+        return NULL;
+    }
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    return (struct cmb_shadow_stack *) ((rt_thread_t) thread)->user_data;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    return (struct cmb_shadow_stack *) ((OS_TCB *) thread)->OSTCBExtPtr;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    return (struct cmb_shadow_stack *) ((OS_TCB *) thread)->ExtPtr;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    return (struct cmb_shadow_stack *) pvTaskGetThreadLocalStoragePointer((TaskHandle_t) thread,
+            CMB_SHADOW_STACK_TLS_INDEX);
+#endif
+}
+
+/**
+ * get the current thread control block by OS variable, so it's safe on the instrumentation hooks
+ *
+ * @return current thread control block, NULL: the OS is not started
+ */
+__attribute__((no_instrument_function))
+static void *shadow_stack_cur_thread(void) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    extern struct rt_thread *rt_current_thread;
+
+    return rt_current_thread;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    extern OS_TCB *OSTCBCur;
+
+    return OSTCBCur;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    extern OS_TCB *OSTCBCurPtr;
+
+    return OSTCBCurPtr;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    extern void * volatile pxCurrentTCB;
+
+    return pxCurrentTCB;
+#endif
+}
+
+/**
+ * set the shadow call stack of thread, it should be called on the thread entry (or before the thread is started),
+ * the thread local storage (RT-Thread: user_data, uC/OS: TCB extension pointer, FreeRTOS: CMB_SHADOW_STACK_TLS_INDEX)
+ * must be reserved for it
+ *
+ * @param thread thread control block, NULL: current thread
+ * @param stack shadow call stack, NULL: disable the shadow call stack of thread
+ */
+void cm_backtrace_shadow_stack_set(void *thread, struct cmb_shadow_stack *stack) {
+    if (thread == NULL) {
+        thread = shadow_stack_cur_thread();
+        CMB_ASSERT(thread);
+    }
+    if (stack != NULL) {
+        stack->depth = 0;
+    }
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    ((rt_thread_t) thread)->user_data = (rt_uint32_t) stack;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    ((OS_TCB *) thread)->OSTCBExtPtr = stack;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    ((OS_TCB *) thread)->ExtPtr = stack;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    vTaskSetThreadLocalStoragePointer((TaskHandle_t) thread, CMB_SHADOW_STACK_TLS_INDEX, stack);
+#endif
+}
+#endif /* CMB_USING_OS_PLATFORM */
+
+/**
+ * get the shadow call stack of current context, the interrupts are using main shadow call stack
+ *
+ * @return shadow call stack, NULL: current thread has no shadow call stack
+ */
+__attribute__((no_instrument_function))
+static struct cmb_shadow_stack *shadow_stack_current(void) {
+#ifdef CMB_USING_OS_PLATFORM
+    if (cmb_get_sp() == cmb_get_psp()) {
+        return shadow_stack_of_thread(shadow_stack_cur_thread());
+    }
+#endif
+
+    return &main_shadow_stack;
+}
+
+/**
+ * function entry hook of -finstrument-functions, it pushes the call site to shadow call stack
+ *
+ * @param this_fn the entered function address
+ * @param call_site the return address of entered function
+ */
+__attribute__((no_instrument_function))
+void __cyg_profile_func_enter(void *this_fn, void *call_site) {
+    struct cmb_shadow_stack *stack = shadow_stack_current();
+    uint32_t depth;
+
+    (void) this_fn;
+
+    if (stack != NULL) {
+        /* the depth is increased before saving, so the preempted interrupt can't overwrite the saving call site */
+        depth = stack->depth++;
+        if (depth < CMB_SHADOW_STACK_DEPTH) {
+            /* the call site is the return address, so need decrease a word to the call instruction */
+            stack->call_sites[depth] = (uint32_t) call_site - sizeof(size_t);
+        }
+    }
+}
+
+/**
+ * function exit hook of -finstrument-functions, it pops the call site from shadow call stack
+ *
+ * @param this_fn the exited function address
+ * @param call_site the return address of exited function
+ */
+__attribute__((no_instrument_function))
+void __cyg_profile_func_exit(void *this_fn, void *call_site) {
+    struct cmb_shadow_stack *stack = shadow_stack_current();
+
+    (void) this_fn;
+    (void) call_site;
+
+    /* the functions which are entered before the shadow call stack is set are not pushed */
+    if (stack != NULL && stack->depth > 0) {
+        stack->depth--;
+    }
+}
+
+/**
+ * copy the shadow call stack to call stack buffer, the innermost call is first
+ *
+ * @param stack shadow call stack
+ * @param buffer call stack buffer
+ * @param depth the depth which is already saved on buffer
+ * @param size buffer size
+ *
+ * @return depth, 0: the shadow call stack is not available
+ */
+static size_t shadow_stack_copy(const struct cmb_shadow_stack *stack, uint32_t *buffer, size_t depth, size_t size) {
+    uint32_t i;
+
+    /* the overflowed shadow call stack has lost the inner calls, so the stack scanning is better */
+    if (stack == NULL || stack->depth == 0 || stack->depth > CMB_SHADOW_STACK_DEPTH) {
+        return 0;
+    }
+    for (i = stack->depth; i > 0 && depth < CMB_CALL_STACK_MAX_DEPTH && depth < size;) {
+        buffer[depth++] = stack->call_sites[--i];
+    }
+
+    return depth;
+}
+
+/**
+ * backtrace function call stack by shadow call stack, it's exact even if the stack is corrupted
+ *
+ * @param buffer call stack buffer
+ * @param size buffer size
+ *
+ * @return depth, 0: the shadow call stack is not available
+ */
+static size_t shadow_stack_call_stack(uint32_t *buffer, size_t size) {
+    const struct cmb_shadow_stack *stack = &main_shadow_stack;
+    size_t depth = 0;
+
+    if (!on_fault) {
+        return shadow_stack_copy(shadow_stack_current(), buffer, 0, size);
+    }
+
+#ifdef CMB_USING_OS_PLATFORM
+    if (on_thread_before_fault) {
+        stack = shadow_stack_of_thread(shadow_stack_cur_thread());
+    }
+#endif
+    /* first depth is PC, the LR is not used because the caller is already saved on shadow call stack */
+    if (!stack_is_overflow && size > 0) {
+        buffer[depth++] = regs.saved.pc;
+    }
+
+    return shadow_stack_copy(stack, buffer, depth, size);
+}
+
+/**
+ * benchmark the overhead of shadow call stack, it should be called on the context which has shadow call stack
+ *
+ * @param count number of benchmarked calls
+ *
+ * @return average overhead of each function entry and exit, the unit is same as cmb_get_timestamp()
+ */
+uint32_t cm_backtrace_shadow_stack_bench(size_t count) {
+    /* the hooks are called by pointer, so they are not inlined as on the instrumented functions */
+    void (* volatile enter_hook)(void *this_fn, void *call_site) = __cyg_profile_func_enter;
+    void (* volatile exit_hook)(void *this_fn, void *call_site) = __cyg_profile_func_exit;
+    void *call_site = __builtin_return_address(0);
+    uint32_t start, loop_time, hook_time;
+    size_t i;
+
+    CMB_ASSERT(count);
+
+    start = cmb_get_timestamp();
+    for (i = 0; i < count; i++) {
+        __asm volatile ("" ::: "memory");
+    }
+    loop_time = cmb_get_timestamp() - start;
+
+    start = cmb_get_timestamp();
+    for (i = 0; i < count; i++) {
+        enter_hook((void *) cm_backtrace_shadow_stack_bench, call_site);
+        exit_hook((void *) cm_backtrace_shadow_stack_bench, call_site);
+    }
+    hook_time = cmb_get_timestamp() - start;
+
+    return hook_time > loop_time ? (hook_time - loop_time) / count : 0;
+}
+#endif /* CMB_USING_SHADOW_STACK */
+
+/**
+ * backtrace function call stack
+ *
+ * @param buffer call stack buffer
+ * @param size buffer size
+ * @param sp stack pointer
+ *
+ * @return depth
+ */
+size_t cm_backtrace_call_stack(uint32_t *buffer, size_t size, uint32_t sp) {
+    uint32_t stack_start_addr = main_stack_start_addr, pc;
+    size_t depth = 0, stack_size = main_stack_size;
+    bool regs_saved_lr_is_valid = false;
+
+#ifdef CMB_USING_SHADOW_STACK
+    if ((depth = shadow_stack_call_stack(buffer, size)) != 0) {
+        return depth;
+    }
+#endif
+
+    if (on_fault) {
+        if (!stack_is_overflow) {
+            /* first depth is PC */
+            buffer[depth++] = regs.saved.pc;
+            /* second depth is from LR, so need decrease a word to PC */
+            pc = regs.saved.lr - sizeof(size_t);
+            if ((pc >= code_start_addr) && (pc <= code_start_addr + code_size) && (depth < CMB_CALL_STACK_MAX_DEPTH)
+                    && (depth < size)) {
+                buffer[depth++] = pc;
+                regs_saved_lr_is_valid = true;
+            }
+        }
+
+#ifdef CMB_USING_OS_PLATFORM
+        /* program is running on thread before fault */
+        if (on_thread_before_fault) {
+            get_cur_thread_stack_info(sp, &stack_start_addr, &stack_size);
+        }
+    } else {
+        /* OS environment */
+        if (cmb_get_sp() == cmb_get_psp()) {
+            get_cur_thread_stack_info(sp, &stack_start_addr, &stack_size);
+        }
+#endif /* CMB_USING_OS_PLATFORM */
+
+    }
+
+    if (stack_is_overflow) {
+        if (sp < stack_start_addr) {
+            sp = stack_start_addr;
+        } else if (sp > stack_start_addr + stack_size) {
+            sp = stack_start_addr + stack_size;
+        }
+    }
+
+    return scan_call_stack(buffer, depth, size, sp, stack_start_addr + stack_size, regs_saved_lr_is_valid);
+}
+
+#ifdef CMB_USING_THREAD_WALK
+/**
+ * walk all threads on OS, the number of threads is limited by CMB_THREAD_MAX_NUM
+ *
+ * @param callback the callback for each thread, NULL: only count the threads
+ * @param arg the callback argument
+ *
+ * @return the number of threads
+ */
+size_t cm_backtrace_foreach_thread(void (*callback)(const struct cmb_thread_info *thread, void *arg), void *arg) {
+    struct cmb_thread_info info;
+    size_t num = 0;
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    struct rt_object_information *information = rt_object_get_information(RT_Object_Class_Thread);
+    struct rt_list_node *node;
+    rt_thread_t thread;
+
+    for (node = information->object_list.next; node != &information->object_list && num < CMB_THREAD_MAX_NUM;
+            node = node->next, num++) {
+        thread = rt_list_entry(node, struct rt_thread, list);
+        info.name = thread->name;
+        info.id = (uint32_t) thread;
+        info.sp = (uint32_t) thread->sp;
+        info.stack_start_addr = (uint32_t) thread->stack_addr;
+        info.stack_size = thread->stack_size;
+        if (callback) {
+            callback(&info, arg);
+        }
+    }
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    extern OS_TCB *OSTCBList;
+    OS_TCB *tcb;
+
+    for (tcb = OSTCBList; tcb != NULL && num < CMB_THREAD_MAX_NUM; tcb = tcb->OSTCBNext, num++) {
+#if OS_TASK_NAME_SIZE > 0 || OS_TASK_NAME_EN > 0
+        info.name = (const char *)tcb->OSTCBTaskName;
+#else
+        info.name = NULL;
+#endif /* OS_TASK_NAME_SIZE > 0 || OS_TASK_NAME_EN > 0 */
+        info.id = (uint32_t) tcb;
+        info.sp = (uint32_t) tcb->OSTCBStkPtr;
+        info.stack_start_addr = (uint32_t) tcb->OSTCBStkBottom;
+        info.stack_size = tcb->OSTCBStkSize * sizeof(OS_STK);
+        if (callback) {
+            callback(&info, arg);
+        }
+    }
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    /* the task debug list needs OS_CFG_DBG_EN */
+    extern OS_TCB *OSTaskDbgListPtr;
+    OS_TCB *tcb;
+
+    for (tcb = OSTaskDbgListPtr; tcb != NULL && num < CMB_THREAD_MAX_NUM; tcb = tcb->DbgNextPtr, num++) {
+        info.name = (const char *)tcb->NamePtr;
+        info.id = (uint32_t) tcb;
+        info.sp = (uint32_t) tcb->StkPtr;
+        info.stack_start_addr = (uint32_t) tcb->StkBasePtr;
+        info.stack_size = tcb->StkSize * sizeof(CPU_STK_SIZE);
+        if (callback) {
+            callback(&info, arg);
+        }
+    }
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    size_t i;
+
+    /* only the cached tasks can be walked */
+    for (i = 0; i < CMB_FREERTOS_TASK_MAX_NUM && num < CMB_THREAD_MAX_NUM; i++) {
+        if (freertos_tasks[i].id) {
+            info = freertos_tasks[i];
+            /* the pxTopOfStack is the first member of TCB */
+            info.sp = *(uint32_t *) info.id;
+            if (callback) {
+                callback(&info, arg);
+            }
+            num++;
+        }
+    }
+#endif
+
+    return num;
+}
+#endif /* CMB_USING_THREAD_WALK */
+
+#if defined(CMB_USING_ALL_THREADS_BACKTRACE) || defined(CMB_USING_PROFILER) || defined(CMB_USING_STACK_CHECK)
+/**
+ * backtrace the function call stack from the hardware saved stack frame, the scanned words are limited by
+ * CMB_THREAD_STACK_SCAN_MAX_WORDS
+ *
+ * @param frame_addr hardware saved stack frame address
+ * @param fpu_frame the hardware saved stack frame has FPU registers
+ * @param stack_start_addr stack start address
+ * @param stack_end_addr stack end address
+ * @param buffer call stack buffer
+ * @param size buffer size
+ *
+ * @return depth
+ */
+static size_t frame_call_stack(uint32_t frame_addr, bool fpu_frame, uint32_t stack_start_addr, uint32_t stack_end_addr,
+        uint32_t *buffer, size_t size) {
+    uint32_t *frame = (uint32_t *) frame_addr, sp, pc;
+    size_t depth = 0;
+    bool regs_saved_lr_is_valid = false;
+
+    /* skip R0~R3, R12, LR, PC, xPSR and S0~S15, FPSCR, reserved */
+    sp = frame_addr + sizeof(size_t) * (8 + (fpu_frame ? 18 : 0));
+    if (frame_addr < stack_start_addr || sp > stack_end_addr) {
+        return 0;
+    }
+    pc = frame[6];
+    if ((pc >= code_start_addr) && (pc <= code_start_addr + code_size) && (depth < size)) {
+        buffer[depth++] = pc;
+    }
+    pc = frame[5] - sizeof(size_t);
+    if ((pc >= code_start_addr) && (pc <= code_start_addr + code_size) && (depth < CMB_CALL_STACK_MAX_DEPTH)
+            && (depth < size)) {
+        buffer[depth++] = pc;
+        regs_saved_lr_is_valid = true;
+    }
+
+    if (stack_end_addr - sp > sizeof(size_t) * CMB_THREAD_STACK_SCAN_MAX_WORDS) {
+        stack_end_addr = sp + sizeof(size_t) * CMB_THREAD_STACK_SCAN_MAX_WORDS;
+    }
+
+    return scan_call_stack(buffer, depth, size, sp, stack_end_addr, regs_saved_lr_is_valid);
+}
+#endif /* defined(CMB_USING_ALL_THREADS_BACKTRACE) || defined(CMB_USING_PROFILER) || ... */
+
+#ifdef CMB_USING_ALL_THREADS_BACKTRACE
+/**
+ * backtrace the function call stack of the thread, the scanned words are limited by CMB_THREAD_STACK_SCAN_MAX_WORDS
+ *
+ * @param thread thread information
+ * @param buffer call stack buffer
+ * @param size buffer size
+ *
+ * @return depth
+ */
+size_t cm_backtrace_thread_call_stack(const struct cmb_thread_info *thread, uint32_t *buffer, size_t size) {
+    uint32_t sp, stack_end_addr;
+    bool fpu_frame;
+#ifdef CMB_USING_SHADOW_STACK
+    size_t depth;
+#endif
+
+    CMB_ASSERT(thread);
+    CMB_ASSERT(buffer);
+
+    stack_end_addr = thread->stack_start_addr + thread->stack_size;
+
+#ifdef CMB_USING_SHADOW_STACK
+    if ((depth = shadow_stack_copy(shadow_stack_of_thread((void *) thread->id), buffer, 0, size)) != 0) {
+        return depth;
+    }
+#endif
+
+    if (thread->id != get_cur_thread_id()) {
+        sp = thread_skip_sw_frame(thread->sp, &fpu_frame);
+        return frame_call_stack(sp, fpu_frame, thread->stack_start_addr, stack_end_addr, buffer, size);
+    }
+
+    /* the running thread has no saved context, scan from current PSP */
+    sp = cmb_get_psp();
+    if (sp < thread->stack_start_addr || sp > stack_end_addr) {
+        return 0;
+    }
+    if (stack_end_addr - sp > sizeof(size_t) * CMB_THREAD_STACK_SCAN_MAX_WORDS) {
+        stack_end_addr = sp + sizeof(size_t) * CMB_THREAD_STACK_SCAN_MAX_WORDS;
+    }
+
+    return scan_call_stack(buffer, 0, size, sp, stack_end_addr, false);
+}
+#endif /* CMB_USING_ALL_THREADS_BACKTRACE */
+
+#ifdef CMB_USING_STACK_HWM
+/**
+ * get the stack high-water mark, the paint boundary is found by binary search, then it is verified by a short
+ * linear probe, because the function may leave some painted words on the used stack (e.g., uninitialized array)
+ *
+ * @param stack_start_addr stack start address
+ * @param stack_size stack size
+ * @param paint the paint word of unused stack
+ *
+ * @return the max used size of stack
+ */
+size_t cm_backtrace_stack_hwm(uint32_t stack_start_addr, size_t stack_size, uint32_t paint) {
+    const uint32_t *stack = (const uint32_t *) stack_start_addr;
+    size_t low = 0, high = stack_size / sizeof(uint32_t), mid, probe = 0;
+
+    /* the first not painted word from the stack start */
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (stack[mid] == paint) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    for (mid = low; mid > 0 && probe < CMB_STACK_HWM_PROBE_WORDS; mid--) {
+        if (stack[mid - 1] != paint) {
+            low = mid - 1;
+            probe = 0;
+        } else {
+            probe++;
+        }
+    }
+
+    return stack_size - low * sizeof(uint32_t);
+}
+
+/**
+ * print the stack high-water mark, or only warn when the headroom is less than CMB_STACK_HWM_WARN_PERCENT
+ *
+ * @param name stack name
+ * @param stack_start_addr stack start address
+ * @param stack_size stack size
+ * @param warn_only only print the warning
+ *
+ * @return true: the headroom is less than CMB_STACK_HWM_WARN_PERCENT
+ */
+static bool print_stack_hwm(const char *name, uint32_t stack_start_addr, size_t stack_size, bool warn_only) {
+    size_t used = cm_backtrace_stack_hwm(stack_start_addr, stack_size, CMB_STACK_PAINT_WORD), percent;
+
+    if (stack_size == 0) {
+        return false;
+    }
+    if (name == NULL) {
+        name = "NO_NAME";
+    }
+
+    percent = (stack_size - used) * 100 / stack_size;
+    if (!warn_only) {
+        cmb_println(print_info[PRINT_STACK_HWM], name, stack_size, used, percent);
+    }
+    if (percent < CMB_STACK_HWM_WARN_PERCENT) {
+        cmb_println(print_info[PRINT_STACK_HWM_WARN], name, percent, stack_size - used);
+        return true;
+    }
+
+    return false;
+}
+
+#ifdef CMB_USING_OS_PLATFORM
+static void print_thread_stack_hwm(const struct cmb_thread_info *thread, void *arg) {
+    bool *warn_only = (bool *) arg;
+
+    print_stack_hwm(thread->name, thread->stack_start_addr, thread->stack_size, *warn_only);
+}
+
+static void check_thread_stack_hwm(const struct cmb_thread_info *thread, void *arg) {
+    size_t *warn_num = (size_t *) arg;
+
+    if (print_stack_hwm(thread->name, thread->stack_start_addr, thread->stack_size, true)) {
+        (*warn_num)++;
+    }
+}
+
+/**
+ * lock the OS scheduler, so the walked threads can't be deleted by other threads
+ */
+static void thread_walk_sched_lock(void) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    rt_enter_critical();
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    OSSchedLock();
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    OS_ERR err;
+
+    OSSchedLock(&err);
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    vTaskSuspendAll();
+#endif
+}
+
+/**
+ * unlock the OS scheduler which is locked by thread_walk_sched_lock
+ */
+static void thread_walk_sched_unlock(void) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    rt_exit_critical();
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    OSSchedUnlock();
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    OS_ERR err;
+
+    OSSchedUnlock(&err);
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    xTaskResumeAll();
+#endif
+}
+#endif /* CMB_USING_OS_PLATFORM */
+
+/**
+ * check the stack high-water mark of main stack and all threads, it is cheap enough to be called periodically
+ * (e.g., every second on a monitor thread), the warning is printed when headroom is less than
+ * CMB_STACK_HWM_WARN_PERCENT. The scheduler is locked on walking the threads, and the cmb_println is non-blocking
+ * as it's used on fault handler.
+ *
+ * @return the number of stacks which headroom is less than CMB_STACK_HWM_WARN_PERCENT
+ */
+size_t cm_backtrace_stack_hwm_check(void) {
+    size_t warn_num = 0;
+
+    CMB_ASSERT(init_ok);
+
+    if (print_stack_hwm("MSP", main_stack_start_addr, main_stack_size, true)) {
+        warn_num++;
+    }
+#ifdef CMB_USING_OS_PLATFORM
+    thread_walk_sched_lock();
+    cm_backtrace_foreach_thread(check_thread_stack_hwm, &warn_num);
+    thread_walk_sched_unlock();
+#endif
+
+    return warn_num;
+}
+
+/**
+ * print the stack high-water mark table of main stack and all threads
+ */
+static void print_stack_hwm_table(void) {
+#ifdef CMB_USING_OS_PLATFORM
+    bool warn_only = false;
+#endif
+
+    cmb_println(print_info[PRINT_STACK_HWM_TITLE]);
+    print_stack_hwm("MSP", main_stack_start_addr, main_stack_size, false);
+#ifdef CMB_USING_OS_PLATFORM
+    cm_backtrace_foreach_thread(print_thread_stack_hwm, &warn_only);
+#endif
+}
+#endif /* CMB_USING_STACK_HWM */
+
+/**
+ * hash one word by FNV-1a
+ *
+ * @param hash current hash value
+ * @param value word
+ *
+ * @return new hash value
+ */
+static uint32_t hash_word(uint32_t hash, uint32_t value) {
+    size_t i;
+
+    for (i = 0; i < sizeof(uint32_t); i++) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 0x01000193;
+    }
+
+    return hash;
+}
+
+/**
+ * hash the function call stack, the address is normalized to the offset from code section start
+ *
+ * @param buffer call stack buffer
+ * @param depth call stack depth
+ *
+ * @return hash value
+ */
+uint32_t cm_backtrace_stack_hash(const uint32_t *buffer, size_t depth) {
+    uint32_t hash = 0x811C9DC5;
+    size_t i;
+
+    for (i = 0; i < depth; i++) {
+        /* ignore the thumb state bit */
+        hash = hash_word(hash, (buffer[i] - code_start_addr) & ~1UL);
+    }
+
+    return hash;
+}
+
+/**
+ * get the fault type, it is the cause bits of all fault status registers
+ */
+static uint32_t get_fault_type(void) {
+    uint32_t type = SIG_TYPE_FAULT;
+
+    if (!on_fault) {
+        return SIG_TYPE_ASSERT;
+    }
+
+    /* the Cortex-M0 is not support fault status registers */
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+    /* the MMARVALID and BFARVALID bits are not the cause */
+    type |= regs.mfsr.value & 0x7F;
+    type |= (uint32_t) (regs.bfsr.value & 0x7F) << 8;
+    type |= (uint32_t) (regs.ufsr.value & 0x3FF) << 16;
+    type |= (uint32_t) regs.hfsr.bits.VECTBL << 26;
+    type |= (uint32_t) regs.hfsr.bits.FORCED << 27;
+    type |= (uint32_t) regs.hfsr.bits.DEBUGEVT << 28;
+#endif
+
+    return type;
+}
+
+/**
+ * calculate the crash signature which covers fault type, PC and the top functions of call stack
+ *
+ * @param type fault type
+ * @param buffer call stack buffer, the first depth is PC
+ * @param depth call stack depth
+ *
+ * @return crash signature
+ */
+static uint32_t calc_signature(uint32_t type, const uint32_t *buffer, size_t depth) {
+    if (depth > CMB_SIGNATURE_DEPTH) {
+        depth = CMB_SIGNATURE_DEPTH;
+    }
+
+    return hash_word(cm_backtrace_stack_hash(buffer, depth), type);
+}
+
+/**
+ * get the last crash signature which was printed by assert or fault
+ *
+ * @return crash signature, 0: no crash signature
+ */
+uint32_t cm_backtrace_signature(void) {
+    return last_signature;
+}
+
+#ifdef CMB_USING_SIG_TABLE
+/**
+ * count the signature on signature table, the call stack only be saved on first instance
+ *
+ * @param signature crash signature
+ * @param type fault type
+ * @param buffer call stack buffer
+ * @param depth call stack depth
+ *
+ * @return occurrence count, 0: the table is full
+ */
+static uint32_t sig_table_count(uint32_t signature, uint32_t type, const uint32_t *buffer, size_t depth) {
+    struct cmb_sig_record *record;
+    size_t i;
+
+    for (i = 0; i < sig_table.num; i++) {
+        if (sig_table.records[i].signature == signature) {
+            return ++sig_table.records[i].count;
+        }
+    }
+
+    if (sig_table.num >= CMB_SIG_TABLE_SIZE) {
+        sig_table.dropped++;
+        return 0;
+    }
+
+    record = &sig_table.records[sig_table.num++];
+    record->signature = signature;
+    record->type = type;
+    record->count = 1;
+    record->depth = depth > CMB_SIG_TABLE_DETAIL_DEPTH ? CMB_SIG_TABLE_DETAIL_DEPTH : depth;
+    memcpy(record->call_stack, buffer, record->depth * sizeof(uint32_t));
+
+    return record->count;
+}
+
+/**
+ * get the crash signature table, it can be saved to flash by user
+ *
+ * @return crash signature table
+ */
+const struct cmb_sig_table *cm_backtrace_sig_table(void) {
+    return &sig_table;
+}
+
+/**
+ * clear all records on crash signature table
+ */
+void cm_backtrace_sig_table_clear(void) {
+    memset(&sig_table, 0, sizeof(sig_table));
+    sig_table.magic = SIG_TABLE_MAGIC;
+}
+#endif /* CMB_USING_SIG_TABLE */
+
+#ifdef CMB_USING_BKP_RECORD
+/**
+ * save the fault micro-record to backup registers, the header is written at last
+ *
+ * @param type fault type
+ * @param signature crash signature
+ * @param thread the faulted thread ID, 0: the fault isn't on thread
+ */
+static void bkp_record_save(uint32_t type, uint32_t signature, uint32_t thread) {
+    struct cmb_bkp_record record;
+
+    record.cause = type;
+    record.pc = regs.saved.pc;
+    record.lr = regs.saved.lr;
+    record.thread = thread;
+    record.signature = signature;
+
+    BKP_REG(1) = record.cause;
+    BKP_REG(2) = record.pc;
+    BKP_REG(3) = record.lr;
+    BKP_REG(4) = record.thread;
+    BKP_REG(5) = record.signature;
+    BKP_REG(0) = (BKP_RECORD_MAGIC << 16) | bkp_record_checksum(&record);
+}
+#endif /* CMB_USING_BKP_RECORD */
+
+/**
+ * capture function call stack then calculate the crash signature
+ *
+ * @param sp stack pointer
+ */
+static void capture_call_stack(uint32_t sp) {
+    uint32_t type;
+
+    call_stack_depth = cm_backtrace_call_stack(call_stack_buf, CMB_CALL_STACK_MAX_DEPTH, sp);
+
+    type = get_fault_type();
+    last_signature = calc_signature(type, call_stack_buf, call_stack_depth);
+
+#ifdef CMB_USING_BKP_RECORD
+    if (on_fault) {
+#ifdef CMB_USING_OS_PLATFORM
+        bkp_record_save(type, last_signature, on_thread_before_fault ? get_cur_thread_id() : 0);
+#else
+        bkp_record_save(type, last_signature, 0);
+#endif
+    }
+#endif
+
+#ifdef CMB_USING_SIG_TABLE
+    last_signature_count = sig_table_count(last_signature, type, call_stack_buf, call_stack_depth);
+#endif
+}
+
+/**
+ * print the crash signature and its count
+ *
+ * @param signature crash signature
+ * @param count the occurred times on signature table, 0: unknown
+ */
+static void print_signature_info(uint32_t signature, uint32_t count) {
+    if (count) {
+        cmb_println(print_info[PRINT_SIGNATURE_COUNT], signature, (unsigned long) count);
+    } else {
+        cmb_println(print_info[PRINT_SIGNATURE], signature);
+    }
+}
+
+/**
+ * print the crash signature
+ */
+static void print_signature(void) {
+#ifdef CMB_USING_SIG_TABLE
+    print_signature_info(last_signature, last_signature_count);
+#else
+    print_signature_info(last_signature, 0);
+#endif /* CMB_USING_SIG_TABLE */
+}
+
+/**
+ * format the function call stack addresses to call_stack_info
+ *
+ * @param buffer call stack buffer
+ * @param depth call stack depth
+ */
+static void format_call_stack(const uint32_t *buffer, size_t depth) {
+    size_t i;
+
+    for (i = 0; i < depth; i++) {
+        sprintf(call_stack_info + i * (8 + 1), "%08lx", buffer[i]);
+        call_stack_info[i * (8 + 1) + 8] = ' ';
+    }
+}
+
+/**
+ * dump the function call stack
+ *
+ * @param buffer call stack buffer
+ * @param depth call stack depth
+ */
+static void print_call_stack_info(const uint32_t *buffer, size_t depth) {
+    format_call_stack(buffer, depth);
+
+    if (depth) {
+        cmb_println(print_info[PRINT_CALL_STACK_INFO], fw_name, CMB_ELF_FILE_EXTENSION_NAME, depth * (8 + 1),
+                call_stack_info);
+    } else {
+        cmb_println(print_info[PRINT_CALL_STACK_ERR]);
+    }
+}
+
+/**
+ * dump the captured function call stack
+ */
+static void print_call_stack(void) {
+    print_call_stack_info(call_stack_buf, call_stack_depth);
+}
+
+#ifdef CMB_USING_ALL_THREADS_BACKTRACE
+/**
+ * print the function call stack of the thread
+ *
+ * @param name thread name
+ * @param buffer call stack buffer
+ * @param depth call stack depth
+ */
+static void print_thread_call_stack_info(const char *name, const uint32_t *buffer, size_t depth) {
+    if (name == NULL) {
+        name = "NO_NAME";
+    }
+
+    format_call_stack(buffer, depth);
+
+    if (depth) {
+        cmb_println(print_info[PRINT_THREAD_CALL_STACK], name, fw_name, CMB_ELF_FILE_EXTENSION_NAME,
+                depth * (8 + 1), call_stack_info);
+    } else {
+        cmb_println(print_info[PRINT_THREAD_CALL_STACK_ERR], name);
+    }
+}
+
+/**
+ * dump the function call stack of the thread, the faulted thread is skipped because it is already dumped
+ *
+ * @param thread thread information
+ * @param arg unused
+ */
+static void print_thread_call_stack(const struct cmb_thread_info *thread, void *arg) {
+    size_t depth;
+
+    if (on_thread_before_fault && thread->id == fault_thread_id) {
+        return;
+    }
+
+    depth = cm_backtrace_thread_call_stack(thread, thread_call_stack_buf, CMB_CALL_STACK_MAX_DEPTH);
+    print_thread_call_stack_info(thread->name, thread_call_stack_buf, depth);
+    cmb_wdt_feed();
+}
+#endif /* CMB_USING_ALL_THREADS_BACKTRACE */
+
+/**
+ * backtrace for assert
+ *
+ * @param sp the stack pointer when on assert occurred
+ */
+void cm_backtrace_assert(uint32_t sp) {
+    CMB_ASSERT(init_ok);
+
+#ifdef CMB_USING_OS_PLATFORM
+    uint32_t cur_stack_pointer = cmb_get_sp();
+#endif
+
+    capture_call_stack(sp);
+
+    /* the most useful information is printed first */
+    cmb_println("");
+    print_signature();
+    print_call_stack();
+    cmb_wdt_feed();
+
+#ifdef CMB_USING_OS_PLATFORM
+    /* OS environment */
+    if (cur_stack_pointer == cmb_get_msp()) {
+        cmb_println(print_info[PRINT_ASSERT_ON_HANDLER]);
+    } else if (cur_stack_pointer == cmb_get_psp()) {
+        cmb_println(print_info[PRINT_ASSERT_ON_THREAD], get_cur_thread_name());
+    }
+#endif /* CMB_USING_OS_PLATFORM */
+
+    cm_backtrace_firmware_info();
+
+#ifdef CMB_USING_DUMP_STACK_INFO
+    cmb_wdt_feed();
+
+#ifdef CMB_USING_OS_PLATFORM
+    if (cur_stack_pointer == cmb_get_msp()) {
+        dump_stack(main_stack_start_addr, main_stack_size, (uint32_t *) sp);
+    } else if (cur_stack_pointer == cmb_get_psp()) {
+        uint32_t stack_start_addr;
+        size_t stack_size;
+        get_cur_thread_stack_info(sp, &stack_start_addr, &stack_size);
+        dump_stack(stack_start_addr, stack_size, (uint32_t *) sp);
+    }
+#else
+    /* bare metal(no OS) environment */
+    dump_stack(main_stack_start_addr, main_stack_size, (uint32_t *) sp);
+#endif /* CMB_USING_OS_PLATFORM */
+
+#endif /* CMB_USING_DUMP_STACK_INFO */
+}
+
+#ifdef CMB_USING_SOFT_ASSERT
+/**
+ * soft assert, it only records the call stack on lock-free ring and returns, so it can be called on hot path and
+ * interrupt. the records are printed by cm_backtrace_soft_assert_drain().
+ * @note the record is dropped when the ring is full
+ *
+ * @param site the assert site ID, e.g., __LINE__ or a hash of __FILE__ and __LINE__
+ * @param sp the stack pointer when on assert occurred
+ */
+void cm_backtrace_soft_assert(uint32_t site, uint32_t sp) {
+    struct soft_assert_record *record;
+    uint32_t pos, dropped;
+    int32_t diff;
+#ifdef CMB_USING_OS_PLATFORM
+    const char *name;
+#endif
+
+    if (!init_ok) {
+        return;
+    }
+
+    /* reserve a free record by moving the head, the producers are serialized by CAS */
+    do {
+        pos = soft_assert_head;
+        record = &soft_assert_ring[pos & (CMB_SOFT_ASSERT_RING_SIZE - 1)];
+        diff = (int32_t) (record->seq - pos);
+        if (diff < 0) {
+            /* the record isn't drained on last lap */
+            do {
+                dropped = soft_assert_dropped;
+            } while (!cmb_atomic_cas(&soft_assert_dropped, dropped, dropped + 1));
+            return;
+        }
+    } while (diff > 0 || !cmb_atomic_cas(&soft_assert_head, pos, pos + 1));
+
+    record->site = site;
+    record->thread[0] = '\0';
+#ifdef CMB_USING_OS_PLATFORM
+    /* the thread may be deleted before the record is drained, so the name is copied */
+    if (cmb_get_sp() == cmb_get_psp()) {
+        name = get_cur_thread_name();
+        strncpy(record->thread, name != NULL ? name : "NO_NAME", CMB_NAME_MAX);
+    }
+#endif
+    record->depth = cm_backtrace_call_stack(record->call_stack, CMB_SOFT_ASSERT_DEPTH, sp);
+
+    /* publish the record after it is filled */
+    cmb_dmb();
+    record->seq = pos + 1;
+}
+
+/**
+ * count the soft assert hits of the site, the site is printed on 1st, 2nd, 4th, 8th ... hit
+ *
+ * @param site the assert site ID
+ * @param hits the site hits
+ *
+ * @return false: the record is suppressed by rate limit
+ */
+static bool soft_assert_rate_limit(uint32_t site, uint32_t *hits) {
+    struct soft_assert_site *free_site = NULL;
+    size_t i;
+
+    for (i = 0; i < CMB_SOFT_ASSERT_SITE_NUM; i++) {
+        if (soft_assert_sites[i].hits == 0) {
+            if (free_site == NULL) {
+                free_site = &soft_assert_sites[i];
+            }
+        } else if (soft_assert_sites[i].site == site) {
+            *hits = ++soft_assert_sites[i].hits;
+            return (*hits & (*hits - 1)) == 0;
+        }
+    }
+
+    if (free_site) {
+        free_site->site = site;
+        free_site->hits = 1;
+    }
+    /* the site isn't limited when the site table is full */
+    *hits = 1;
+
+    return true;
+}
+
+/**
+ * print the soft assert records on ring, it should be called periodically on a low priority thread (or idle hook),
+ * only one thread can drain the ring
+ *
+ * @return the number of drained records
+ */
+size_t cm_backtrace_soft_assert_drain(void) {
+    struct soft_assert_record *record, copy;
+    uint32_t hits, dropped;
+    size_t num = 0;
+
+    while (1) {
+        record = &soft_assert_ring[soft_assert_tail & (CMB_SOFT_ASSERT_RING_SIZE - 1)];
+        if (record->seq != soft_assert_tail + 1) {
+            break;
+        }
+        cmb_dmb();
+        copy = *record;
+        /* release the record for next lap before the slow printing */
+        cmb_dmb();
+        record->seq = soft_assert_tail + CMB_SOFT_ASSERT_RING_SIZE;
+        soft_assert_tail++;
+        num++;
+
+        if (!soft_assert_rate_limit(copy.site, &hits)) {
+            continue;
+        }
+        format_call_stack(copy.call_stack, copy.depth);
+        if (copy.thread[0] != '\0') {
+            cmb_println(print_info[PRINT_SOFT_ASSERT_ON_THREAD], copy.site, CMB_NAME_MAX, copy.thread, hits, fw_name,
+                    CMB_ELF_FILE_EXTENSION_NAME, copy.depth * (8 + 1), call_stack_info);
+        } else {
+            cmb_println(print_info[PRINT_SOFT_ASSERT_ON_HANDLER], copy.site, hits, fw_name,
+                    CMB_ELF_FILE_EXTENSION_NAME, copy.depth * (8 + 1), call_stack_info);
+        }
+    }
+
+    dropped = soft_assert_dropped;
+    if (dropped != soft_assert_dropped_printed) {
+        cmb_println(print_info[PRINT_SOFT_ASSERT_DROPPED], dropped - soft_assert_dropped_printed);
+        soft_assert_dropped_printed = dropped;
+    }
+
+    return num;
+}
+#endif /* CMB_USING_SOFT_ASSERT */
+
+#ifdef CMB_USING_ASSERT_REGISTRY
+/**
+ * count the hit of assert site, the sites beyond CMB_ASSERT_SITE_MAX_NUM are not counted
+ *
+ * @param site assert site descriptor on assert site section
+ *
+ * @return assert site index
+ */
+size_t cm_backtrace_assert_site_hit(const struct cmb_assert_site *site) {
+    size_t index = site - ASSERT_SITE_START;
+    uint32_t primask;
+
+    if (index < CMB_ASSERT_SITE_MAX_NUM) {
+        primask = cmb_irq_lock();
+        assert_site_hits[index]++;
+        cmb_irq_unlock(primask);
+    }
+
+    return index;
+}
+
+/**
+ * assert on the registered site, it is called by CMB_SITE_ASSERT. the site is counted then reported by soft assert
+ * (the site ID is the site index) when CMB_USING_SOFT_ASSERT is enabled, otherwise it's reported by assert
+ *
+ * @param site assert site descriptor on assert site section
+ * @param sp the stack pointer when on assert occurred
+ */
+void cm_backtrace_assert_site(const struct cmb_assert_site *site, uint32_t sp) {
+    size_t index = cm_backtrace_assert_site_hit(site);
+
+    if (!init_ok) {
+        return;
+    }
+
+#ifdef CMB_USING_SOFT_ASSERT
+    cm_backtrace_soft_assert(index, sp);
+#else
+    cmb_println(print_info[PRINT_ASSERT_SITE], index, site->file_id, site->line,
+            index < CMB_ASSERT_SITE_MAX_NUM ? assert_site_hits[index] : 0);
+    cm_backtrace_assert(sp);
+#endif
+}
+
+/**
+ * print the assert sites which are hit, the file ID and line of each site are read from assert site section
+ */
+void cm_backtrace_assert_site_dump(void) {
+    size_t i, num = ASSERT_SITE_END - ASSERT_SITE_START;
+
+    cmb_println(print_info[PRINT_ASSERT_SITE_TITLE], num);
+    for (i = 0; i < num && i < CMB_ASSERT_SITE_MAX_NUM; i++) {
+        if (assert_site_hits[i]) {
+            cmb_println(print_info[PRINT_ASSERT_SITE], i, ASSERT_SITE_START[i].file_id, ASSERT_SITE_START[i].line,
+                    assert_site_hits[i]);
+        }
+    }
+}
+#endif /* CMB_USING_ASSERT_REGISTRY */
+
+#if defined(CMB_USING_PROFILER) || defined(CMB_USING_TICK_SAMPLER) || defined(CMB_USING_HANG_CAPTURE)
+/**
+ * find the hardware saved stack frame of the context which is interrupted by the sampling interrupt. The interrupt
+ * handler calls other function, so it has saved EXC_RETURN on main stack, the stack is scanned upward from current
+ * stack pointer until a valid EXC_RETURN which matches the stack frame.
+ *
+ * @param exc_return the found EXC_RETURN
+ *
+ * @return hardware saved stack frame address, 0: not found
+ */
+static uint32_t exc_frame_find(uint32_t *exc_return) {
+    uint32_t sp = cmb_get_sp(), stack_end_addr = main_stack_start_addr + main_stack_size, value, frame, psr;
+    size_t i;
+
+    for (i = 0; i < EXC_FRAME_SCAN_MAX_WORDS && sp < stack_end_addr; i++, sp += sizeof(size_t)) {
+        value = *(uint32_t *) sp;
+        /* EXC_RETURN is 0xFFFFFFE1, 0xFFFFFFE9, 0xFFFFFFED, 0xFFFFFFF1, 0xFFFFFFF9 or 0xFFFFFFFD */
+        if ((value & 0xFFFFFFE0) != 0xFFFFFFE0 || ((value & 0x0F) != 0x01 && (value & 0x0F) != 0x09
+                && (value & 0x0F) != 0x0D)) {
+            continue;
+        }
+        /* the stack frame is on PSP when EXC_RETURN bit2 is set, otherwise it's above the saved EXC_RETURN */
+        frame = (value & (1UL << 2)) ? cmb_get_psp() : sp + sizeof(size_t);
+        psr = ((uint32_t *) frame)[7];
+        /* verify the frame by Thumb bit, IPSR (it's 0 only on thread mode) and PC */
+        if (!(psr & (1UL << 24)) || ((psr & 0x1FF) == 0) != ((value & (1UL << 3)) != 0)
+                || ((uint32_t *) frame)[6] < code_start_addr || ((uint32_t *) frame)[6] > code_start_addr + code_size) {
+            continue;
+        }
+        *exc_return = value;
+        return frame;
+    }
+
+    return 0;
+}
+#endif /* defined(CMB_USING_PROFILER) || defined(CMB_USING_TICK_SAMPLER) || defined(CMB_USING_HANG_CAPTURE) */
+
+#ifdef CMB_USING_TICK_SAMPLER
+/**
+ * record the PC, LR and thread of the context which is interrupted by tick, it should be called by the SysTick handler
+ * (or the OS tick hook). The ring is retained over the reset, so it shows where the program was spinning on a lockup.
+ */
+void cm_backtrace_tick_sample(void) {
+    struct cmb_tick_sample *sample;
+    uint32_t exc_return, frame;
+
+    if (tick_sampler.magic != TICK_SAMPLER_MAGIC) {
+        return;
+    }
+
+    frame = exc_frame_find(&exc_return);
+    if (frame == 0) {
+        return;
+    }
+
+    sample = &tick_sampler.samples[tick_sampler.index++ & (CMB_TICK_SAMPLER_SIZE - 1)];
+    sample->pc = ((uint32_t *) frame)[6];
+    sample->lr = ((uint32_t *) frame)[5];
+#ifdef CMB_USING_OS_PLATFORM
+    /* the thread is interrupted when EXC_RETURN bit3 (return to thread mode) is set */
+    sample->thread = (exc_return & (1UL << 3)) ? get_cur_thread_id() : 0;
+#else
+    sample->thread = 0;
+#endif
+}
+
+/**
+ * get the tick sampler, the samples before last reset are cleared after they are printed on library initialize
+ *
+ * @return tick sampler
+ */
+const struct cmb_tick_sampler *cm_backtrace_tick_sampler(void) {
+    return &tick_sampler;
+}
+#endif /* CMB_USING_TICK_SAMPLER */
+
+#ifdef CMB_USING_PROFILER
+/**
+ * start the sampling profiler, the old samples are cleared
+ */
+void cm_backtrace_profiler_start(void) {
+    profiler_running = false;
+    profiler_samples = 0;
+    profiler_dropped = 0;
+    memset(profiler_records, 0, sizeof(profiler_records));
+    profiler_running = true;
+}
+
+/**
+ * stop the sampling profiler, the samples are kept for dump
+ */
+void cm_backtrace_profiler_stop(void) {
+    profiler_running = false;
+}
+
+/**
+ * take a sample of the interrupted context, it should be called by a periodic timer interrupt handler which is not
+ * preempted by other sampling. The call stack of sample is counted on a fixed size open addressing hash table,
+ * so there is no memory allocation on interrupt.
+ */
+void cm_backtrace_profiler_sample(void) {
+    uint32_t exc_return, frame, hash, index, stack_start_addr = main_stack_start_addr;
+    size_t i, depth, stack_size = main_stack_size;
+    bool fpu_frame = false;
+    struct cmb_profiler_record *record;
+#ifdef CMB_USING_STACK_OWNER
+    struct cmb_stack_owner owner;
+#endif
+
+    if (!profiler_running) {
+        return;
+    }
+
+    frame = exc_frame_find(&exc_return);
+    if (frame == 0) {
+        profiler_dropped++;
+        return;
+    }
+
+#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
+    fpu_frame = !(exc_return & (1UL << 4));
+#endif
+
+#ifdef CMB_USING_STACK_OWNER
+    /* the stack which has the frame is found on index, so it doesn't depend on the current thread of OS */
+    if (cm_backtrace_stack_owner(frame, &owner)) {
+        stack_start_addr = owner.start_addr;
+        stack_size = owner.end_addr - owner.start_addr;
+    }
+#ifdef CMB_USING_OS_PLATFORM
+    /* the thread isn't on index yet, e.g., it's created before the hook is set */
+    else if (exc_return & (1UL << 2)) {
+        get_cur_thread_stack_info(frame, &stack_start_addr, &stack_size);
+    }
+#endif
+#elif defined(CMB_USING_OS_PLATFORM)
+    if (exc_return & (1UL << 2)) {
+        get_cur_thread_stack_info(frame, &stack_start_addr, &stack_size);
+    }
+#endif
+
+    depth = frame_call_stack(frame, fpu_frame, stack_start_addr, stack_start_addr + stack_size, profiler_call_stack,
+            CMB_PROFILER_DEPTH);
+    /* the hash 0 is used by empty record */
+    hash = cm_backtrace_stack_hash(profiler_call_stack, depth);
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    profiler_samples++;
+    for (i = 0, index = hash; i < CMB_PROFILER_TABLE_SIZE; i++, index++) {
+        record = &profiler_records[index & (CMB_PROFILER_TABLE_SIZE - 1)];
+        if (record->hash == hash) {
+            record->count++;
+            return;
+        } else if (record->hash == 0) {
+            record->count = 1;
+            record->depth = depth;
+            memcpy(record->call_stack, profiler_call_stack, depth * sizeof(uint32_t));
+            record->hash = hash;
+            return;
+        }
+    }
+
+    /* the table is full */
+    profiler_dropped++;
+}
+
+/**
+ * dump the sampled call stacks as folded stacks for flame graph, the caller is first, e.g., "0800a1c2;08003d4e 37".
+ * the addresses can be converted to function names by tools/profiler/cmb_folded.py
+ */
+void cm_backtrace_profiler_dump(void) {
+    const struct cmb_profiler_record *record;
+    size_t i, j;
+
+    cmb_println(print_info[PRINT_PROFILER_TITLE], profiler_samples, profiler_dropped);
+    for (i = 0; i < CMB_PROFILER_TABLE_SIZE; i++) {
+        record = &profiler_records[i];
+        if (record->hash == 0 || record->depth == 0) {
+            continue;
+        }
+        for (j = 0; j < record->depth; j++) {
+            sprintf(call_stack_info + j * (8 + 1), "%08lx", record->call_stack[record->depth - 1 - j]);
+            call_stack_info[j * (8 + 1) + 8] = ';';
+        }
+        cmb_println("%.*s %lu", record->depth * (8 + 1) - 1, call_stack_info, (unsigned long) record->count);
+    }
+}
+#endif /* CMB_USING_PROFILER */
+
+#ifdef CMB_USING_IPC_PROFILER
+/**
+ * clear the IPC contention records
+ */
+void cm_backtrace_ipc_profiler_clear(void) {
+    uint32_t primask = cmb_irq_lock();
+
+    memset(ipc_contentions, 0, sizeof(ipc_contentions));
+    ipc_contention_num = 0;
+    ipc_contention_dropped = 0;
+    cmb_irq_unlock(primask);
+}
+
+/**
+ * dump the top contended call sites which are sorted by total wait duration
+ *
+ * @param top number of dumped call sites, 0: all
+ */
+void cm_backtrace_ipc_profiler_dump(size_t top) {
+    const struct cmb_ipc_contention *record, *max;
+    uint32_t last_total = UINT32_MAX;
+    const uint32_t *last = NULL;
+    size_t i, n;
+
+    if (top == 0 || top > ipc_contention_num) {
+        top = ipc_contention_num;
+    }
+
+    cmb_println(print_info[PRINT_IPC_PROFILER_TITLE], ipc_contention_num, ipc_contention_dropped, top);
+    for (n = 0; n < top; n++) {
+        /* select the next record by total wait, the same total records are ordered by table position */
+        max = NULL;
+        for (i = 0; i < CMB_IPC_PROFILER_TABLE_SIZE; i++) {
+            record = &ipc_contentions[i];
+            if (record->hash == 0 || record->total_wait > last_total
+                    || (record->total_wait == last_total && &record->hash <= last)) {
+                continue;
+            }
+            if (max == NULL || record->total_wait > max->total_wait) {
+                max = record;
+            }
+        }
+        if (max == NULL) {
+            break;
+        }
+        last_total = max->total_wait;
+        last = &max->hash;
+
+        format_call_stack(max->call_stack, max->depth);
+        cmb_println(print_info[PRINT_IPC_CONTENTION], CMB_IPC_PROFILER_NAME_MAX, max->object_name, max->object,
+                max->count, max->total_wait, max->max_wait, CMB_IPC_PROFILER_NAME_MAX, max->holder_name, fw_name,
+                CMB_ELF_FILE_EXTENSION_NAME, max->depth * (8 + 1), call_stack_info);
+    }
+}
+#endif /* CMB_USING_IPC_PROFILER */
+
+#ifdef CMB_USING_HEAP_TRACKER
+/**
+ * the start index of the allocated block on live allocation table, the heap blocks are aligned to 8 bytes at least
+ *
+ * @param ptr allocated block address
+ *
+ * @return index
+ */
+static size_t heap_alloc_index(uint32_t ptr) {
+    return (ptr >> 3) & (CMB_HEAP_TRACKER_ALLOC_NUM - 1);
+}
+
+/**
+ * remove the live allocation from table, the following allocations are shifted back to keep the linear probing chain,
+ * so there is no tombstone on table. It must be called with interrupts locked.
+ *
+ * @param index the removed allocation index
+ */
+static void heap_alloc_remove(size_t index) {
+    struct heap_alloc *alloc = &heap_allocs[index];
+    struct cmb_heap_site *site = &heap_sites[alloc->site];
+    size_t i, home;
+
+    site->live_bytes -= alloc->size;
+    site->live_num--;
+    heap_live_bytes -= alloc->size;
+    heap_live_num--;
+
+    alloc->ptr = 0;
+    for (i = (index + 1) & (CMB_HEAP_TRACKER_ALLOC_NUM - 1); heap_allocs[i].ptr; i = (i + 1)
+            & (CMB_HEAP_TRACKER_ALLOC_NUM - 1)) {
+        home = heap_alloc_index(heap_allocs[i].ptr);
+        /* the allocation can't be moved before its start index */
+        if ((index <= i) ? (index < home && home <= i) : (index < home || home <= i)) {
+            continue;
+        }
+        heap_allocs[index] = heap_allocs[i];
+        heap_allocs[i].ptr = 0;
+        index = i;
+    }
+}
+
+/**
+ * find and remove the live allocation by block address. It must be called with interrupts locked.
+ *
+ * @param ptr block address
+ */
+static void heap_alloc_untrack(uint32_t ptr) {
+    size_t i, index;
+
+    for (i = 0, index = heap_alloc_index(ptr); i < CMB_HEAP_TRACKER_ALLOC_NUM; i++, index++) {
+        index &= CMB_HEAP_TRACKER_ALLOC_NUM - 1;
+        if (heap_allocs[index].ptr == ptr) {
+            heap_alloc_remove(index);
+            return;
+        } else if (heap_allocs[index].ptr == 0) {
+            return;
+        }
+    }
+}
+
+/**
+ * track an allocated block, it should be called after the allocation is successful, e.g., traceMALLOC on FreeRTOS,
+ * or after Mem_HeapAlloc/OSMemGet on uC/OS. The RT-Thread heap and memory pool are hooked on cm_backtrace_init.
+ * The allocation site is the hash of a short caller call stack, the sites and live allocations are on fixed size
+ * open addressing hash tables, so the cost is the short call stack scan and a few probes. The site which has no live
+ * allocation is reused by the new site on its probing chain.
+ *
+ * @param ptr allocated block address, NULL: allocation is failed
+ * @param size allocated block size
+ */
+void cm_backtrace_heap_alloc(void *ptr, size_t size) {
+    uint32_t call_stack[CMB_HEAP_TRACKER_DEPTH], hash, primask;
+    struct cmb_heap_site *site = NULL, *free_site = NULL, *probe;
+    struct heap_alloc *alloc = NULL;
+    size_t i, index, depth;
+
+    if (ptr == NULL || !init_ok) {
+        return;
+    }
+
+    memset(call_stack, 0, sizeof(call_stack));
+    /* the scan starts above the call stack buffer, so the stale words of this frame aren't taken as return address */
+    depth = cm_backtrace_call_stack(call_stack, CMB_HEAP_TRACKER_DEPTH,
+            (uint32_t) (call_stack + CMB_HEAP_TRACKER_DEPTH));
+    /* the hash 0 is used by empty site */
+    hash = cm_backtrace_stack_hash(call_stack, depth);
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    primask = cmb_irq_lock();
+    for (i = 0, index = hash; i < CMB_HEAP_TRACKER_SITE_NUM; i++, index++) {
+        probe = &heap_sites[index & (CMB_HEAP_TRACKER_SITE_NUM - 1)];
+        if (probe->hash == hash) {
+            site = probe;
+            break;
+        } else if (free_site == NULL && (probe->hash == 0 || probe->live_num == 0)) {
+            /* the site without live allocation keeps the probing chain, it's reused when the site isn't found */
+            free_site = probe;
+        }
+        if (probe->hash == 0) {
+            break;
+        }
+    }
+    if (site == NULL && free_site) {
+        site = free_site;
+        memset(site, 0, sizeof(struct cmb_heap_site));
+        site->hash = hash;
+        site->depth = depth;
+        memcpy(site->call_stack, call_stack, depth * sizeof(uint32_t));
+    }
+
+    if (site) {
+        /* the free of last block on same address may be missed, e.g., it's resized in place */
+        heap_alloc_untrack((uint32_t) ptr);
+        for (i = 0, index = heap_alloc_index((uint32_t) ptr); i < CMB_HEAP_TRACKER_ALLOC_NUM; i++, index++) {
+            index &= CMB_HEAP_TRACKER_ALLOC_NUM - 1;
+            if (heap_allocs[index].ptr == 0) {
+                alloc = &heap_allocs[index];
+                break;
+            }
+        }
+    }
+
+    if (alloc) {
+        alloc->ptr = (uint32_t) ptr;
+        alloc->size = size;
+        alloc->site = site - heap_sites;
+        site->live_bytes += size;
+        site->live_num++;
+        site->alloc_num++;
+        heap_live_bytes += size;
+        heap_live_num++;
+    } else {
+        /* the site or live allocation table is full */
+        heap_untracked_num++;
+    }
+    cmb_irq_unlock(primask);
+}
+
+/**
+ * untrack a block which is going to be freed, e.g., traceFREE on FreeRTOS, or before OSMemPut on uC/OS
+ *
+ * @param ptr block address, the untracked block is ignored
+ */
+void cm_backtrace_heap_free(void *ptr) {
+    uint32_t primask;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    primask = cmb_irq_lock();
+    heap_alloc_untrack((uint32_t) ptr);
+    cmb_irq_unlock(primask);
+}
+
+/**
+ * dump the top allocation sites which are sorted by live bytes, the slow leak is the site which live bytes keep
+ * growing on each dump
+ *
+ * @param top number of dumped sites, 0: all
+ */
+void cm_backtrace_heap_dump(size_t top) {
+    const struct cmb_heap_site *site, *max;
+    uint32_t last_bytes = UINT32_MAX;
+    const uint32_t *last = NULL;
+    size_t i, n, num = 0;
+
+    for (i = 0; i < CMB_HEAP_TRACKER_SITE_NUM; i++) {
+        if (heap_sites[i].hash && heap_sites[i].live_num) {
+            num++;
+        }
+    }
+    if (top == 0 || top > num) {
+        top = num;
+    }
+
+    cmb_println(print_info[PRINT_HEAP_TRACKER_TITLE], heap_live_bytes, heap_live_num, heap_untracked_num, top);
+    for (n = 0; n < top; n++) {
+        /* select the next site by live bytes, the same live bytes sites are ordered by table position */
+        max = NULL;
+        for (i = 0; i < CMB_HEAP_TRACKER_SITE_NUM; i++) {
+            site = &heap_sites[i];
+            if (site->hash == 0 || site->live_num == 0 || site->live_bytes > last_bytes
+                    || (site->live_bytes == last_bytes && &site->hash <= last)) {
+                continue;
+            }
+            if (max == NULL || site->live_bytes > max->live_bytes) {
+                max = site;
+            }
+        }
+        if (max == NULL) {
+            break;
+        }
+        last_bytes = max->live_bytes;
+        last = &max->hash;
+
+        format_call_stack(max->call_stack, max->depth);
+        cmb_println(print_info[PRINT_HEAP_SITE], max->live_bytes, max->live_num, max->alloc_num, fw_name,
+                CMB_ELF_FILE_EXTENSION_NAME, max->depth * (8 + 1), call_stack_info);
+    }
+}
+#endif /* CMB_USING_HEAP_TRACKER */
+
+#ifdef CMB_USING_HEAP_VERIFY
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_SMALL_MEM) && !defined(RT_USING_MEMHEAP_AS_HEAP)
+/**
+ * verify the RT-Thread small memory (mem.c) block header, the header layout is same as struct heap_mem on mem.c
+ *
+ * @param region heap region
+ * @param block block header address
+ * @param size block size
+ * @param used the block is used
+ *
+ * @return next block header address, HEAP_BLOCK_END: the last block, HEAP_BLOCK_CORRUPTED: corrupted
+ */
+static uint32_t rtt_mem_block_check(const struct heap_region *region, uint32_t block, uint32_t *size, bool *used) {
+    uint32_t offset = block - region->begin, end_offset = region->end - region->begin, next;
+    const struct rtt_heap_mem *mem = (const struct rtt_heap_mem *) block;
+
+    if (mem->magic != RTT_HEAP_MAGIC || mem->used > 1) {
+        return HEAP_BLOCK_CORRUPTED;
+    }
+    /* the end block is always used */
+    if (offset == end_offset) {
+        return mem->used ? HEAP_BLOCK_END : HEAP_BLOCK_CORRUPTED;
+    }
+    next = mem->next;
+    if (next <= offset || next > end_offset || next - offset < RTT_HEAP_MEM_SIZE || next % RT_ALIGN_SIZE
+            || (next != end_offset && ((const struct rtt_heap_mem *) (region->begin + next))->prev != offset)) {
+        return HEAP_BLOCK_CORRUPTED;
+    }
+    *size = next - offset - RTT_HEAP_MEM_SIZE;
+    *used = mem->used;
+
+    return region->begin + next;
+}
+#endif /* (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_SMALL_MEM) && ... */
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_MEMHEAP)
+/**
+ * verify the RT-Thread memory heap (memheap.c) item, the free item is also verified on free list
+ *
+ * @param region heap region
+ * @param block item address
+ * @param size block size
+ * @param used the block is used
+ *
+ * @return next item address, HEAP_BLOCK_END: the last item, HEAP_BLOCK_CORRUPTED: corrupted
+ */
+static uint32_t rtt_memheap_block_check(const struct heap_region *region, uint32_t block, uint32_t *size,
+        bool *used) {
+    const struct rt_memheap_item *item = (const struct rt_memheap_item *) block;
+    uint32_t next = (uint32_t) item->next;
+
+    if ((item->magic & RTT_MEMHEAP_MASK) != RTT_MEMHEAP_MAGIC || item->pool_ptr != region->object
+            || next < region->begin || next >= region->end || item->next->prev != item) {
+        return HEAP_BLOCK_CORRUPTED;
+    }
+    /* the tailer item is used and its next is the first item */
+    if (next == region->begin) {
+        return (item->magic & RTT_MEMHEAP_USED) ? HEAP_BLOCK_END : HEAP_BLOCK_CORRUPTED;
+    }
+    if (next - block < RTT_MEMHEAP_SIZE || (!(item->magic & RTT_MEMHEAP_USED) && (item->next_free->prev_free != item
+            || item->prev_free->next_free != item))) {
+        return HEAP_BLOCK_CORRUPTED;
+    }
+    *size = next - block - RTT_MEMHEAP_SIZE;
+    *used = item->magic & RTT_MEMHEAP_USED;
+
+    return next;
+}
+#endif /* (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_MEMHEAP) */
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+/**
+ * verify the FreeRTOS heap_4/heap_5 block header, the allocated block has no next free block, the free list is
+ * ordered by address. The end block of a heap_5 region which isn't the last region links to the free blocks of next
+ * region, so only the last end block has no next free block.
+ *
+ * @param region heap region
+ * @param block block header address
+ * @param size block size
+ * @param used the block is used
+ *
+ * @return next block header address, HEAP_BLOCK_END: the end block, HEAP_BLOCK_CORRUPTED: corrupted
+ */
+static uint32_t freertos_block_check(const struct heap_region *region, uint32_t block, uint32_t *size, bool *used) {
+    const struct freertos_block_link *link = (const struct freertos_block_link *) block;
+    uint32_t block_size = link->block_size & ~FREERTOS_BLOCK_ALLOCATED_BIT;
+
+    /* the end block has no size */
+    if (block == region->end) {
+        return (link->block_size == 0 && (link->next_free == NULL || ((uint32_t) link->next_free > block
+                && !((uint32_t) link->next_free & portBYTE_ALIGNMENT_MASK)))) ? HEAP_BLOCK_END : HEAP_BLOCK_CORRUPTED;
+    }
+    if (block_size < 2 * FREERTOS_HEAP_STRUCT_SIZE || (block_size & portBYTE_ALIGNMENT_MASK)
+            || block_size > region->end - block) {
+        return HEAP_BLOCK_CORRUPTED;
+    }
+    *used = (link->block_size & FREERTOS_BLOCK_ALLOCATED_BIT) != 0;
+    if (*used ? link->next_free != NULL : ((uint32_t) link->next_free <= block
+            || ((uint32_t) link->next_free & portBYTE_ALIGNMENT_MASK))) {
+        return HEAP_BLOCK_CORRUPTED;
+    }
+    *size = block_size - FREERTOS_HEAP_STRUCT_SIZE;
+
+    return block + block_size;
+}
+#endif /* (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS) */
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+/**
+ * verify the uC/OS-II memory partition free block, the partition has no block header, so the free list is verified
+ *
+ * @param region heap region
+ * @param block free block address
+ * @param size block size
+ * @param used the block is used, it's always false
+ *
+ * @return next free block address, HEAP_BLOCK_END: the last free block, HEAP_BLOCK_CORRUPTED: corrupted
+ */
+static uint32_t ucosii_block_check(const struct heap_region *region, uint32_t block, uint32_t *size, bool *used) {
+    const OS_MEM *mem = (const OS_MEM *) region->object;
+    uint32_t next;
+
+    if (block < region->begin || block >= region->end || (block - region->begin) % mem->OSMemBlkSize) {
+        return HEAP_BLOCK_CORRUPTED;
+    }
+    next = *(uint32_t *) block;
+    *size = mem->OSMemBlkSize;
+    *used = false;
+
+    return next ? next : HEAP_BLOCK_END;
+}
+#endif /* (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII) */
+
+/**
+ * get the heap region by index, the registered regions are first, then the OS heap objects (RT-Thread memheap or
+ * uC/OS-II memory partition)
+ *
+ * @param index region index
+ * @param region heap region
+ *
+ * @return false: the region is not exist
+ */
+static bool heap_region_get(size_t index, struct heap_region *region) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_MEMHEAP)
+    struct rt_object_information *information;
+    struct rt_list_node *node;
+    struct rt_memheap *memheap;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    OS_MEM *mem;
+#endif
+
+    if (index < heap_region_num) {
+        *region = heap_regions[index];
+        return true;
+    }
+    index -= heap_region_num;
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_MEMHEAP)
+    information = rt_object_get_information(RT_Object_Class_MemHeap);
+    for (node = information->object_list.next; node != &information->object_list; node = node->next) {
+        if (index-- == 0) {
+            memheap = (struct rt_memheap *) rt_list_entry(node, struct rt_object, list);
+            region->type = HEAP_TYPE_RTT_MEMHEAP;
+            region->begin = (uint32_t) memheap->start_addr;
+            region->end = region->begin + memheap->pool_size;
+            region->object = memheap;
+            return true;
+        }
+    }
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    for (mem = &OSMemTbl[0]; mem < &OSMemTbl[OS_MAX_MEM_PART]; mem++) {
+        /* the partition which is not created has no address */
+        if (mem->OSMemAddr != NULL && index-- == 0) {
+            region->type = HEAP_TYPE_UCOSII_PARTITION;
+            region->begin = (uint32_t) mem->OSMemAddr;
+            region->end = region->begin + mem->OSMemNBlks * mem->OSMemBlkSize;
+            region->object = mem;
+            return true;
+        }
+    }
+#endif
+
+    return false;
+}
+
+/**
+ * get the first block of heap region
+ *
+ * @param region heap region
+ *
+ * @return the first block address, 0: the region has no block (e.g., FreeRTOS heap_4 is not initialized)
+ */
+static uint32_t heap_first_block(const struct heap_region *region) {
+    switch (region->type) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    case HEAP_TYPE_FREERTOS:
+        /* heap_4 is initialized on first pvPortMalloc */
+        return ((const struct freertos_block_link *) region->begin)->block_size ? region->begin : 0;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    case HEAP_TYPE_UCOSII_PARTITION:
+        return (uint32_t) ((const OS_MEM *) region->object)->OSMemFreeList;
+#endif
+    default:
+        return region->begin;
+    }
+}
+
+/**
+ * verify the heap block
+ *
+ * @param region heap region
+ * @param block block address
+ * @param size block size
+ * @param used the block is used
+ *
+ * @return next block address, HEAP_BLOCK_END: the last block, HEAP_BLOCK_CORRUPTED: corrupted
+ */
+static uint32_t heap_block_check(const struct heap_region *region, uint32_t block, uint32_t *size, bool *used) {
+    switch (region->type) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_SMALL_MEM) && !defined(RT_USING_MEMHEAP_AS_HEAP)
+    case HEAP_TYPE_RTT_MEM:
+        return rtt_mem_block_check(region, block, size, used);
+#endif
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_MEMHEAP)
+    case HEAP_TYPE_RTT_MEMHEAP:
+        return rtt_memheap_block_check(region, block, size, used);
+#endif
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    case HEAP_TYPE_FREERTOS:
+        return freertos_block_check(region, block, size, used);
+#endif
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    case HEAP_TYPE_UCOSII_PARTITION:
+        return ucosii_block_check(region, block, size, used);
+#endif
+    default:
+        return HEAP_BLOCK_CORRUPTED;
+    }
+}
+
+/**
+ * get the change stamp of heap region, the walk is restarted when it's changed between the slices
+ *
+ * @param region heap region
+ *
+ * @return stamp
+ */
+static uint32_t heap_region_stamp(const struct heap_region *region) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    return xPortGetFreeHeapSize();
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    return region->type == HEAP_TYPE_UCOSII_PARTITION ? ((const OS_MEM *) region->object)->OSMemNFree : 0;
+#else
+    /* the RT-Thread heap blocks have previous link, so the changed block can be found by header verify */
+    return 0;
+#endif
+}
+
+/**
+ * register a heap region for verifier, the RT-Thread memheap and uC/OS-II memory partitions are found automatically
+ *
+ * @param begin_addr heap begin address, it's same as rt_system_heap_init (RT-Thread small memory), ucHeap (FreeRTOS
+ *        heap_4) or HeapRegion_t (FreeRTOS heap_5)
+ * @param end_addr heap end address
+ *
+ * @return number of the registered regions, 0: the region table is full or the heap is not supported
+ */
+size_t cm_backtrace_heap_verify_add(const void *begin_addr, const void *end_addr) {
+    struct heap_region *region;
+
+    if (heap_region_num >= CMB_HEAP_VERIFY_REGION_NUM) {
+        return 0;
+    }
+
+    region = &heap_regions[heap_region_num];
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_SMALL_MEM) && !defined(RT_USING_MEMHEAP_AS_HEAP)
+    /* same as rt_system_heap_init on mem.c, the end is the end block header */
+    region->type = HEAP_TYPE_RTT_MEM;
+    region->begin = RT_ALIGN((uint32_t) begin_addr, RT_ALIGN_SIZE);
+    region->end = RT_ALIGN_DOWN((uint32_t) end_addr, RT_ALIGN_SIZE) - RTT_HEAP_MEM_SIZE;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    /* same as prvHeapInit on heap_4.c and vPortDefineHeapRegions on heap_5.c, the end is the end block header */
+    region->type = HEAP_TYPE_FREERTOS;
+    region->begin = ((uint32_t) begin_addr + portBYTE_ALIGNMENT_MASK) & ~portBYTE_ALIGNMENT_MASK;
+    region->end = ((uint32_t) end_addr - FREERTOS_HEAP_STRUCT_SIZE) & ~portBYTE_ALIGNMENT_MASK;
+#else
+    return 0;
+#endif
+    region->object = NULL;
+
+    return ++heap_region_num;
+}
+
+/**
+ * verify the heap by a small slice, it should be called by idle hook (it's hooked by rt_thread_idle_sethook on
+ * RT-Thread). At most CMB_HEAP_VERIFY_SLICE_BLOCKS blocks are verified with interrupts locked, the walk is continued
+ * from the last verified block on next slice, and restarted when the heap is changed between the slices.
+ *
+ * @return the corrupted block address, 0: no corruption is found. The corruption is only reported once.
+ */
+uint32_t cm_backtrace_heap_verify(void) {
+    struct heap_region region;
+    uint32_t primask, block, next, size;
+    bool used, resumed;
+    size_t i;
+
+    if (heap_corrupted_block) {
+        return heap_corrupted_block;
+    }
+
+    primask = cmb_irq_lock();
+    if (!heap_region_get(heap_verify_region, &region)) {
+        heap_verify_region = 0;
+        heap_verify_block = 0;
+        if (!heap_region_get(heap_verify_region, &region)) {
+            cmb_irq_unlock(primask);
+            return 0;
+        }
+    }
+
+    /* the last verified block is verified again and the walk is continued from its next block */
+    block = heap_verify_block;
+    resumed = block != 0;
+    if (resumed && (heap_region_stamp(&region) != heap_verify_stamp
+            || memcmp((void *) block, heap_verify_header, sizeof(heap_verify_header)))) {
+        block = 0;
+    }
+
+    for (i = 0; i < CMB_HEAP_VERIFY_SLICE_BLOCKS; i++) {
+        if (block == 0) {
+            block = heap_first_block(&region);
+            heap_verify_stamp = heap_region_stamp(&region);
+            heap_verify_steps = 0;
+            resumed = false;
+            if (block == 0) {
+                break;
+            }
+        }
+        next = heap_block_check(&region, block, &size, &used);
+        if (next == HEAP_BLOCK_CORRUPTED || heap_verify_steps++ > (region.end - region.begin) / sizeof(size_t)) {
+            if (resumed) {
+                /* the resumed block may be merged to other block, so the walk is restarted */
+                block = 0;
+                continue;
+            }
+            heap_corrupted_block = block;
+            break;
+        }
+        resumed = false;
+        if (next == HEAP_BLOCK_END) {
+            block = 0;
+            break;
+        }
+        heap_verify_block = block;
+        memcpy(heap_verify_header, (void *) block, sizeof(heap_verify_header));
+        block = next;
+    }
+
+    /* move to next region when the region walk is finished */
+    if (block == 0) {
+        heap_verify_region++;
+        heap_verify_block = 0;
+    }
+    cmb_irq_unlock(primask);
+
+    if (heap_corrupted_block) {
+        cmb_println(print_info[PRINT_HEAP_CORRUPTED], heap_corrupted_block, region.begin, region.end);
+    }
+
+    return heap_corrupted_block;
+}
+
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+/**
+ * verify the heap region which has the fault address (MMAR or BFAR), all blocks of the region are verified,
+ * so the corruption around the fault address is found
+ *
+ * @param addr fault address
+ */
+static void heap_verify_fault_addr(uint32_t addr) {
+    struct heap_region region;
+    uint32_t block, next, size, fault_block = 0, fault_size = 0;
+    bool used, fault_used = false;
+    size_t index, steps;
+
+    for (index = 0; heap_region_get(index, &region); index++) {
+        if (addr < region.begin || addr > region.end) {
+            continue;
+        }
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+        /* the partition has no block header, the block is free when it's on free list */
+        if (region.type == HEAP_TYPE_UCOSII_PARTITION) {
+            fault_size = ((const OS_MEM *) region.object)->OSMemBlkSize;
+            fault_block = addr - (addr - region.begin) % fault_size;
+            fault_used = true;
+        }
+#endif
+        for (block = heap_first_block(&region), steps = 0; block; block = next, steps++) {
+            next = heap_block_check(&region, block, &size, &used);
+            if (next == HEAP_BLOCK_CORRUPTED || steps > (region.end - region.begin) / sizeof(size_t)) {
+                cmb_println(print_info[PRINT_HEAP_CORRUPTED], block, region.begin, region.end);
+                return;
+            }
+            if (next == HEAP_BLOCK_END) {
+                break;
+            }
+            if (block == fault_block) {
+                fault_used = false;
+            } else if (fault_block == 0 && addr >= block && addr < next) {
+                fault_block = block;
+                fault_size = size;
+                fault_used = used;
+            }
+        }
+        if (fault_block) {
+            cmb_println(print_info[PRINT_HEAP_FAULT_BLOCK], addr, fault_block, fault_size, fault_used);
+        }
+        return;
+    }
+}
+
+/**
+ * verify the heap around the valid fault address
+ */
+static void print_heap_fault_addr(void) {
+    if (regs.mfsr.bits.MMARVALID) {
+        heap_verify_fault_addr(regs.mmar);
+    }
+    if (regs.bfsr.bits.BFARVALID) {
+        heap_verify_fault_addr(regs.bfar);
+    }
+}
+#endif /* (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0) */
+#endif /* CMB_USING_HEAP_VERIFY */
+
+#ifdef CMB_USING_HANG_CAPTURE
+/**
+ * save the thread call stack to hang record, the interrupted thread call stack is already captured
+ *
+ * @param thread thread information
+ * @param arg unused
+ */
+static void hang_record_thread(const struct cmb_thread_info *thread, void *arg) {
+    struct cmb_hang_thread *record;
+
+    if (hang_record.thread_num >= CMB_HANG_THREAD_MAX_NUM) {
+        return;
+    }
+
+    record = &hang_record.threads[hang_record.thread_num++];
+    record->id = thread->id;
+    if (on_thread_before_fault && thread->id == fault_thread_id) {
+        record->depth = call_stack_depth > CMB_HANG_CALL_STACK_DEPTH ? CMB_HANG_CALL_STACK_DEPTH : call_stack_depth;
+        memcpy(record->call_stack, call_stack_buf, record->depth * sizeof(uint32_t));
+    } else {
+        record->depth = cm_backtrace_thread_call_stack(thread, record->call_stack, CMB_HANG_CALL_STACK_DEPTH);
+    }
+}
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+/**
+ * save the owned or waited IPC objects of the class to hang record
+ *
+ * @param type object class, RT_Object_Class_Mutex or RT_Object_Class_Semaphore
+ */
+static void hang_record_ipc(enum rt_object_class_type type) {
+    struct rt_object_information *information = rt_object_get_information(type);
+    struct rt_list_node *node, *waiter;
+    struct rt_ipc_object *ipc;
+    struct cmb_hang_ipc *record;
+    uint32_t owner, value, waiter_num;
+    size_t num = 0;
+
+    for (node = information->object_list.next; node != &information->object_list && num < HANG_IPC_SCAN_MAX_NUM;
+            node = node->next, num++) {
+        ipc = (struct rt_ipc_object *) rt_list_entry(node, struct rt_object, list);
+        owner = 0;
+        value = 0;
+#ifdef RT_USING_MUTEX
+        if (type == RT_Object_Class_Mutex) {
+            owner = (uint32_t) ((struct rt_mutex *) ipc)->owner;
+            value = ((struct rt_mutex *) ipc)->hold;
+        }
+#endif
+#ifdef RT_USING_SEMAPHORE
+        if (type == RT_Object_Class_Semaphore) {
+            value = ((struct rt_semaphore *) ipc)->value;
+        }
+#endif
+        for (waiter = ipc->suspend_thread.next, waiter_num = 0;
+                waiter != &ipc->suspend_thread && waiter_num < CMB_THREAD_MAX_NUM; waiter = waiter->next) {
+            waiter_num++;
+        }
+        /* only the owned or waited objects are related to hang */
+        if (owner == 0 && waiter_num == 0) {
+            continue;
+        }
+        if (hang_record.ipc_num >= CMB_HANG_IPC_MAX_NUM) {
+            return;
+        }
+
+        record = &hang_record.ipcs[hang_record.ipc_num++];
+        record->object = (uint32_t) ipc;
+        record->type = type;
+        record->owner = owner;
+        record->value = value;
+        record->waiter_num = waiter_num;
+        record->waiter = waiter_num ? (uint32_t) rt_list_entry(ipc->suspend_thread.next, struct rt_thread, tlist) : 0;
+    }
+}
+
+/**
+ * print the owned or waited IPC objects on hang record
+ */
+static void print_hang_ipc(void) {
+    const struct cmb_hang_ipc *record;
+    const char *owner, *waiter;
+    size_t i;
+
+    cmb_println(print_info[PRINT_HANG_IPC_TITLE]);
+    for (i = 0; i < hang_record.ipc_num; i++) {
+        record = &hang_record.ipcs[i];
+        owner = record->owner ? get_thread_name(record->owner) : "-";
+        waiter = record->waiter ? get_thread_name(record->waiter) : "-";
+        if (record->type == RT_Object_Class_Mutex) {
+            cmb_println(print_info[PRINT_HANG_IPC_MUTEX], RT_NAME_MAX, ((struct rt_object *) record->object)->name,
+                    record->object, RT_NAME_MAX, owner, record->value, record->waiter_num, RT_NAME_MAX, waiter);
+        } else {
+            cmb_println(print_info[PRINT_HANG_IPC_SEMAPHORE], RT_NAME_MAX, ((struct rt_object *) record->object)->name,
+                    record->object, record->value, record->waiter_num, RT_NAME_MAX, waiter);
+        }
+    }
+}
+#endif /* (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) */
+
+/**
+ * capture the hang information, it should be called by the watchdog early warning interrupt (e.g., WWDG EWI) or a
+ * hardware timer which is restarted by the watchdog feeding thread. The hang record, crash signature and backup
+ * micro-record are saved before printing, so they are retained even if the watchdog resets on printing.
+ */
+void cm_backtrace_hang(void) {
+    uint32_t type = SIG_TYPE_HANG, stack_start_addr, frame, exc_return;
+    size_t i, stack_size;
+    const struct cmb_hang_thread *thread;
+    bool fpu_frame = false;
+
+    CMB_ASSERT(init_ok);
+
+    /* the interrupted context is known by the EXC_RETURN which is saved by the early warning interrupt handler */
+    frame = exc_frame_find(&exc_return);
+    if (frame) {
+        /* the interrupted context is thread when the frame is on PSP */
+        on_thread_before_fault = (exc_return & (1UL << 2)) != 0;
+#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
+        fpu_frame = !(exc_return & (1UL << 4));
+#endif
+    } else {
+#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M0)
+        /* the ARMv6-M has no RETTOBASE, so the interrupted context is unknown */
+        on_thread_before_fault = false;
+#else
+        /* the interrupted context is thread when there is no other active exception */
+        on_thread_before_fault = (CMB_NVIC_ICSR & (1UL << 11)) != 0;
+        if (on_thread_before_fault) {
+            frame = cmb_get_psp();
+        }
+#endif
+    }
+
+    regs.saved.pc = 0;
+    regs.saved.lr = 0;
+    fault_thread_id = 0;
+    if (frame) {
+        regs.saved.pc = ((uint32_t *) frame)[6];
+        regs.saved.lr = ((uint32_t *) frame)[5];
+    }
+    if (on_thread_before_fault) {
+        fault_thread_id = get_cur_thread_id();
+        fault_thread_name = get_cur_thread_name();
+        get_cur_thread_stack_info(frame, &stack_start_addr, &stack_size);
+        call_stack_depth = frame_call_stack(frame, fpu_frame, stack_start_addr, stack_start_addr + stack_size,
+                call_stack_buf, CMB_CALL_STACK_MAX_DEPTH);
+    } else if (frame) {
+        /* the hung interrupt stack frame is on main stack */
+        call_stack_depth = frame_call_stack(frame, fpu_frame, main_stack_start_addr,
+                main_stack_start_addr + main_stack_size, call_stack_buf, CMB_CALL_STACK_MAX_DEPTH);
+    } else {
+        /* the hung interrupt stack frame is unknown, so the main stack is scanned from current stack pointer */
+        call_stack_depth = cm_backtrace_call_stack(call_stack_buf, CMB_CALL_STACK_MAX_DEPTH, cmb_get_sp());
+    }
+    last_signature = calc_signature(type, call_stack_buf, call_stack_depth);
+
+    /* the hang record is valid after all data is saved */
+    hang_record.magic = 0;
+    hang_record.signature = last_signature;
+    hang_record.thread = fault_thread_id;
+    hang_record.thread_num = 0;
+    hang_record.ipc_num = 0;
+    cm_backtrace_foreach_thread(hang_record_thread, NULL);
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+#ifdef RT_USING_MUTEX
+    hang_record_ipc(RT_Object_Class_Mutex);
+#endif
+#ifdef RT_USING_SEMAPHORE
+    hang_record_ipc(RT_Object_Class_Semaphore);
+#endif
+#endif /* (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) */
+    hang_record.magic = HANG_RECORD_MAGIC;
+
+#ifdef CMB_USING_BKP_RECORD
+    bkp_record_save(type, last_signature, fault_thread_id);
+#endif
+
+#ifdef CMB_USING_SIG_TABLE
+    last_signature_count = sig_table_count(last_signature, type, call_stack_buf, call_stack_depth);
+#endif
+
+    cmb_println("");
+    print_signature();
+    if (frame) {
+        cmb_println(print_info[PRINT_FAULT_PC_LR], regs.saved.pc, regs.saved.lr);
+    }
+    print_call_stack();
+    if (on_thread_before_fault) {
+        cmb_println(print_info[PRINT_HANG_ON_THREAD], fault_thread_name != NULL ? fault_thread_name : "NO_NAME");
+    } else {
+        cmb_println(print_info[PRINT_HANG_ON_HANDLER]);
+    }
+    cmb_wdt_feed();
+
+    cmb_println(print_info[PRINT_ALL_THREADS_TITLE]);
+    for (i = 0; i < hang_record.thread_num; i++) {
+        thread = &hang_record.threads[i];
+        if (thread->id != hang_record.thread) {
+            print_thread_call_stack_info(get_thread_name(thread->id), thread->call_stack, thread->depth);
+        }
+    }
+
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    cmb_wdt_feed();
+    print_hang_ipc();
+#endif
+
+#ifdef CMB_USING_SWITCH_RECORDER
+    cmb_wdt_feed();
+    print_switch_recorder(PRINT_SWITCH_RECORDER_TITLE);
+#endif
+
+#ifdef CMB_USING_IRQ_RECORDER
+    cmb_wdt_feed();
+    print_irq_recorder(PRINT_IRQ_RECORDER_TITLE);
+#endif
+
+    cm_backtrace_firmware_info();
+}
+#endif /* CMB_USING_HANG_CAPTURE */
+
+#ifdef CMB_USING_STACK_CHECK
+/**
+ * set the hook which is called after the stack overflow is printed by cm_backtrace_stack_overflow_report, e.g.,
+ * suspend the overflowed thread or reset
+ *
+ * @param hook the stack overflow hook, NULL: no hook
+ */
+void cm_backtrace_stack_overflow_sethook(void (*hook)(const struct cmb_stack_overflow_record *record)) {
+    stack_overflow_hook = hook;
+}
+
+/**
+ * get the stack overflow record which is detected on context switch
+ *
+ * @return stack overflow record, NULL: there is no stack overflow
+ */
+const struct cmb_stack_overflow_record *cm_backtrace_stack_overflow_record(void) {
+    return stack_overflow_recorded ? &stack_overflow_record : NULL;
+}
+
+/**
+ * record the stack overflow of the switched out (or switched in on RT-Thread) thread, the call stack is backtraced from
+ * its saved context immediately. It's called by the context switch stack check, and it also can be called by
+ * vApplicationStackOverflowHook (FreeRTOS). It runs on the scheduler (PendSV or critical section), so nothing is
+ * printed, the record is printed by cm_backtrace_stack_overflow_report. The stack overflow is only recorded once.
+ *
+ * @param thread the overflowed thread control block address, its context must be saved
+ */
+void cm_backtrace_stack_overflow(void *thread) {
+    struct cmb_stack_overflow_record *record = &stack_overflow_record;
+    uint32_t type = SIG_TYPE_STACK_OVERFLOW, stack_end_addr, addr, frame;
+    const char *name;
+    bool fpu_frame;
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    struct cmb_thread_info *info;
+#endif
+
+    CMB_ASSERT(init_ok);
+    CMB_ASSERT(thread);
+
+    if (stack_overflow_recorded) {
+        return;
+    }
+    stack_overflow_recorded = true;
+
+    record->thread = (uint32_t) thread;
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    record->sp = (uint32_t) ((struct rt_thread *) thread)->sp;
+    record->stack_start_addr = (uint32_t) ((struct rt_thread *) thread)->stack_addr;
+    record->stack_size = ((struct rt_thread *) thread)->stack_size;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    record->sp = (uint32_t) ((OS_TCB *) thread)->OSTCBStkPtr;
+    record->stack_start_addr = (uint32_t) ((OS_TCB *) thread)->OSTCBStkBottom;
+    record->stack_size = ((OS_TCB *) thread)->OSTCBStkSize * sizeof(OS_STK);
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    record->sp = (uint32_t) ((OS_TCB *) thread)->StkPtr;
+    record->stack_start_addr = (uint32_t) ((OS_TCB *) thread)->StkBasePtr;
+    record->stack_size = ((OS_TCB *) thread)->StkSize * sizeof(CPU_STK_SIZE);
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    /* the pxTopOfStack is the first member of TCB, the stack bounds are unknown when the task isn't cached */
+    record->sp = *(uint32_t *) thread;
+    info = freertos_task_find(thread);
+    record->stack_start_addr = info ? info->stack_start_addr : record->sp;
+    record->stack_size = info ? info->stack_size : 0;
+#endif
+    stack_end_addr = record->stack_start_addr + record->stack_size;
+
+    /* the high-water mark is from the first unpainted word or the saved stack pointer which is under the stack */
+    for (addr = record->stack_start_addr; addr < record->sp && addr < stack_end_addr
+            && *(uint32_t *) addr == CMB_STACK_PAINT_WORD; addr += sizeof(size_t));
+    record->hwm = record->sp < addr ? stack_end_addr - record->sp : stack_end_addr - addr;
+
+    /* the saved context may be under the stack start address, so it's also scanned */
+    frame = thread_skip_sw_frame(record->sp, &fpu_frame);
+    record->pc = ((uint32_t *) frame)[6];
+    record->lr = ((uint32_t *) frame)[5];
+    record->depth = frame_call_stack(frame, fpu_frame, record->sp < record->stack_start_addr ? record->sp
+            : record->stack_start_addr, stack_end_addr, record->call_stack, CMB_CALL_STACK_MAX_DEPTH);
+    record->signature = calc_signature(type, record->call_stack, record->depth);
+    last_signature = record->signature;
+
+    /* the thread may be deleted before the record is printed */
+    name = get_thread_name(record->thread);
+    strncpy(record->name, name != NULL ? name : "NO_NAME", CMB_NAME_MAX);
+
+#ifdef CMB_USING_BKP_RECORD
+    bkp_record_save(type, record->signature, record->thread);
+#endif
+
+#ifdef CMB_USING_SIG_TABLE
+    stack_overflow_signature_count = sig_table_count(record->signature, type, record->call_stack, record->depth);
+#endif
+
+    stack_overflow_pending = true;
+#ifdef CMB_USING_DEFERRED_REPORT
+    CMB_DEFERRED_REPORT_TRIGGER();
+#endif
+}
+
+/**
+ * print the stack overflow record once and call the stack overflow hook. It should be called on a thread (e.g., idle
+ * hook or a monitor thread), it's also called by cm_backtrace_fault_report when CMB_USING_DEFERRED_REPORT is used.
+ * It does nothing when no stack overflow is pending.
+ */
+void cm_backtrace_stack_overflow_report(void) {
+    const struct cmb_stack_overflow_record *record = &stack_overflow_record;
+
+    if (!stack_overflow_pending) {
+        return;
+    }
+    stack_overflow_pending = false;
+
+    cmb_println("");
+#ifdef CMB_USING_SIG_TABLE
+    print_signature_info(record->signature, stack_overflow_signature_count);
+#else
+    print_signature_info(record->signature, 0);
+#endif
+    cmb_println(print_info[PRINT_FAULT_PC_LR], record->pc, record->lr);
+    print_call_stack_info(record->call_stack, record->depth);
+    cmb_println(print_info[PRINT_STACK_OVERFLOW_ON_SWITCH], CMB_NAME_MAX, record->name, record->thread,
+            record->stack_start_addr, record->stack_size, record->sp, record->hwm);
+
+#ifdef CMB_USING_SWITCH_RECORDER
+    cmb_wdt_feed();
+    print_switch_recorder(PRINT_SWITCH_RECORDER_TITLE);
+#endif
+
+    cm_backtrace_firmware_info();
+
+    if (stack_overflow_hook) {
+        stack_overflow_hook(record);
+    }
+}
+#endif /* CMB_USING_STACK_CHECK */
+
+#ifdef CMB_USING_STACK_OWNER
+/**
+ * print the stack owner when the address is on a stack, the stack of other context than the faulted context is warned
+ *
+ * @param name address name, e.g., register name
+ * @param addr address
+ */
+static void print_stack_owner(const char *name, uint32_t addr) {
+    struct cmb_stack_owner owner;
+    const char *owner_name = "MSP";
+
+    if (!cm_backtrace_stack_owner(addr, &owner)) {
+        return;
+    }
+
+    if (owner.thread && (owner_name = get_thread_name(owner.thread)) == NULL) {
+        owner_name = "NO_NAME";
+    }
+    if (owner.thread == (on_thread_before_fault ? fault_thread_id : 0)) {
+        cmb_println(print_info[PRINT_STACK_OWNER], name, addr, owner_name, owner.thread);
+    } else {
+        cmb_println(print_info[PRINT_STACK_OWNER_OTHER], name, addr, owner_name, owner.thread);
+    }
+}
+
+/**
+ * print the stack owners of the saved registers, stack pointer and fault address
+ */
+static void print_fault_stack_owner(void) {
+    if (stack_owner_dropped) {
+        cmb_println(print_info[PRINT_STACK_OWNER_DROPPED], stack_owner_dropped);
+    }
+
+    /* the stack frame may be get failed when it is overflow  */
+    if (!stack_is_overflow) {
+        print_stack_owner("R0", regs.saved.r0);
+        print_stack_owner("R1", regs.saved.r1);
+        print_stack_owner("R2", regs.saved.r2);
+        print_stack_owner("R3", regs.saved.r3);
+        print_stack_owner("R12", regs.saved.r12);
+    }
+    print_stack_owner("SP", fault_stack_pointer);
+
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+    if (regs.mfsr.bits.MMARVALID) {
+        print_stack_owner("MMAR", regs.mmar);
+    }
+    if (regs.bfsr.bits.BFARVALID) {
+        print_stack_owner("BFAR", regs.bfar);
+    }
+#endif
+}
+#endif /* CMB_USING_STACK_OWNER */
+
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+/**
+ * fault diagnosis then print cause of fault
+ */
+static void fault_diagnosis(void) {
+    if (regs.hfsr.bits.VECTBL) {
+        cmb_println(print_info[PRINT_HFSR_VECTBL]);
+    }
+    /* the configurable fault is forced to hard fault, or handled by it's own handler */
+    if (regs.hfsr.bits.FORCED || regs.syshndctrl.bits.MEMFAULTACT || regs.syshndctrl.bits.BUSFAULTACT
+            || regs.syshndctrl.bits.USGFAULTACT) {
+        /* Memory Management Fault */
+        if (regs.mfsr.value) {
+            if (regs.mfsr.bits.IACCVIOL) {
+                cmb_println(print_info[PRINT_MFSR_IACCVIOL]);
+            }
+            if (regs.mfsr.bits.DACCVIOL) {
+                cmb_println(print_info[PRINT_MFSR_DACCVIOL]);
+            }
+            if (regs.mfsr.bits.MUNSTKERR) {
+                cmb_println(print_info[PRINT_MFSR_MUNSTKERR]);
+            }
+            if (regs.mfsr.bits.MSTKERR) {
+                cmb_println(print_info[PRINT_MFSR_MSTKERR]);
+            }
+
+#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
+            if (regs.mfsr.bits.MLSPERR) {
+                cmb_println(print_info[PRINT_MFSR_MLSPERR]);
+            }
+#endif
+
+            if (regs.mfsr.bits.MMARVALID) {
+                if (regs.mfsr.bits.IACCVIOL || regs.mfsr.bits.DACCVIOL) {
+                    cmb_println(print_info[PRINT_MMAR], regs.mmar);
+                }
+            }
+        }
+        /* Bus Fault */
+        if (regs.bfsr.value) {
+            if (regs.bfsr.bits.IBUSERR) {
+                cmb_println(print_info[PRINT_BFSR_IBUSERR]);
+            }
+            if (regs.bfsr.bits.PRECISERR) {
+                cmb_println(print_info[PRINT_BFSR_PRECISERR]);
+            }
+            if (regs.bfsr.bits.IMPREISERR) {
+                cmb_println(print_info[PRINT_BFSR_IMPREISERR]);
+            }
+            if (regs.bfsr.bits.UNSTKERR) {
+                cmb_println(print_info[PRINT_BFSR_UNSTKERR]);
+            }
+            if (regs.bfsr.bits.STKERR) {
+                cmb_println(print_info[PRINT_BFSR_STKERR]);
+            }
+
+#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
+            if (regs.bfsr.bits.LSPERR) {
+                cmb_println(print_info[PRINT_BFSR_LSPERR]);
+            }
+#endif
+
+            if (regs.bfsr.bits.BFARVALID) {
+                if (regs.bfsr.bits.PRECISERR) {
+                    cmb_println(print_info[PRINT_BFAR], regs.bfar);
+                }
+            }
+
+        }
+        /* Usage Fault */
+        if (regs.ufsr.value) {
+            if (regs.ufsr.bits.UNDEFINSTR) {
+                cmb_println(print_info[PRINT_UFSR_UNDEFINSTR]);
+            }
+            if (regs.ufsr.bits.INVSTATE) {
+                cmb_println(print_info[PRINT_UFSR_INVSTATE]);
+            }
+            if (regs.ufsr.bits.INVPC) {
+                cmb_println(print_info[PRINT_UFSR_INVPC]);
+            }
+            if (regs.ufsr.bits.NOCP) {
+                cmb_println(print_info[PRINT_UFSR_NOCP]);
+            }
+            if (regs.ufsr.bits.UNALIGNED) {
+                cmb_println(print_info[PRINT_UFSR_UNALIGNED]);
+            }
+            if (regs.ufsr.bits.DIVBYZERO0) {
+                cmb_println(print_info[PRINT_UFSR_DIVBYZERO0]);
+            }
+        }
+    }
+    /* Debug Fault */
+    if (regs.hfsr.bits.DEBUGEVT) {
+        if (regs.dfsr.value) {
+            if (regs.dfsr.bits.HALTED) {
+                cmb_println(print_info[PRINT_DFSR_HALTED]);
+            }
+            if (regs.dfsr.bits.BKPT) {
+                cmb_println(print_info[PRINT_DFSR_BKPT]);
+            }
+            if (regs.dfsr.bits.DWTTRAP) {
+                cmb_println(print_info[PRINT_DFSR_DWTTRAP]);
+            }
+            if (regs.dfsr.bits.VCATCH) {
+                cmb_println(print_info[PRINT_DFSR_VCATCH]);
+            }
+            if (regs.dfsr.bits.EXTERNAL) {
+                cmb_println(print_info[PRINT_DFSR_EXTERNAL]);
+            }
+        }
+    }
+}
+#endif /* (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0) */
+
+#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
+static uint32_t statck_del_fpu_regs(uint32_t fault_handler_lr, uint32_t sp) {
+    statck_has_fpu_regs = (fault_handler_lr & (1UL << 4)) == 0 ? true : false;
+
+    /* the stack has S0~S15 and FPSCR registers when statck_has_fpu_regs is true, double word align */
+    return statck_has_fpu_regs == true ? sp + sizeof(size_t) * 18 : sp;
+}
+#endif
+
+#ifdef CMB_USING_PHASE_TIMING
+/**
+ * record the elapsed time of the phase
+ *
+ * @param phase phase, e.g., CMB_PHASE_CAPTURE
+ * @param start the start timestamp by cmb_get_timestamp()
+ */
+static void phase_record(size_t phase, uint32_t start) {
+    struct cmb_phase_time *time = &phase_timing.phases[phase];
+    uint32_t elapsed = cmb_get_timestamp() - start;
+
+    time->last = elapsed;
+    if (time->count == 0 || elapsed < time->min) {
+        time->min = elapsed;
+    }
+    if (elapsed > time->max) {
+        time->max = elapsed;
+    }
+    time->count++;
+}
+
+/**
+ * get the fault path phase timing, it's read for latency budget checking, e.g., on the next fault or unit test
+ *
+ * @return phase timing
+ */
+const struct cmb_phase_timing *cm_backtrace_phase_timing(void) {
+    return &phase_timing;
+}
+
+/**
+ * clear the fault path phase timing
+ */
+void cm_backtrace_phase_timing_clear(void) {
+    memset(&phase_timing, 0, sizeof(phase_timing));
+}
+
+#ifdef CMB_PHASE_TIMING_ON_REPORT
+/**
+ * print the fault path phase timing
+ */
+static void print_phase_timing(void) {
+    const struct cmb_phase_time *time;
+    size_t i;
+
+    cmb_println(print_info[PRINT_PHASE_TIMING_TITLE]);
+    for (i = 0; i < CMB_PHASE_NUM; i++) {
+        time = &phase_timing.phases[i];
+        if (time->count) {
+            cmb_println(print_info[PRINT_PHASE_CAPTURE + i], time->last, time->min, time->max);
+        }
+    }
+    cmb_println("==============================================================");
+}
+#endif /* CMB_PHASE_TIMING_ON_REPORT */
+#endif /* CMB_USING_PHASE_TIMING */
+
+/**
+ * capture the fault registers, stack information and call stack, it doesn't print anything
+ *
+ * @param fault_handler_lr the LR register value on fault handler
+ * @param fault_handler_sp the stack pointer on fault handler
+ */
+static void fault_capture(uint32_t fault_handler_lr, uint32_t fault_handler_sp) {
+    uint32_t stack_pointer = fault_handler_sp, saved_regs_addr = stack_pointer;
+#ifdef CMB_USING_PHASE_TIMING
+    uint32_t start;
+#endif
+
+    PHASE_START(start);
+
+    fault_stack_start_addr = main_stack_start_addr;
+    fault_stack_size = main_stack_size;
 
 #ifdef CMB_USING_OS_PLATFORM
-    /* OS environment */
-    if (cur_stack_pointer == cmb_get_msp()) {
-        cmb_println(print_info[PRINT_ASSERT_ON_HANDLER]);
+    on_thread_before_fault = fault_handler_lr & (1UL << 2);
+    /* check which stack was used before (MSP or PSP) */
+    if (on_thread_before_fault) {
+        saved_regs_addr = stack_pointer = cmb_get_psp();
+        get_cur_thread_stack_info(stack_pointer, &fault_stack_start_addr, &fault_stack_size);
+        fault_thread_name = get_cur_thread_name();
+#if defined(CMB_USING_ALL_THREADS_BACKTRACE) || defined(CMB_USING_STACK_OWNER)
+        fault_thread_id = get_cur_thread_id();
+#endif
+    }
+#endif /* CMB_USING_OS_PLATFORM */
 
-#ifdef CMB_USING_DUMP_STACK_INFO
-        dump_stack(main_stack_start_addr, main_stack_size, (uint32_t *) sp);
-#endif /* CMB_USING_DUMP_STACK_INFO */
+    /* delete saved R0~R3, R12, LR,PC,xPSR registers space */
+    stack_pointer += sizeof(size_t) * 8;
 
-    } else if (cur_stack_pointer == cmb_get_psp()) {
-        cmb_println(print_info[PRINT_ASSERT_ON_THREAD], get_cur_thread_name());
+#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
+    stack_pointer = statck_del_fpu_regs(fault_handler_lr, stack_pointer);
+#endif /* (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7) */
 
 #ifdef CMB_USING_DUMP_STACK_INFO
-        uint32_t stack_start_addr;
-        size_t stack_size;
-        get_cur_thread_stack_info(sp, &stack_start_addr, &stack_size);
-        dump_stack(stack_start_addr, stack_size, (uint32_t *) sp);
+    /* check stack overflow */
+    if (stack_pointer < fault_stack_start_addr || stack_pointer > fault_stack_start_addr + fault_stack_size) {
+        stack_is_overflow = true;
+    }
 #endif /* CMB_USING_DUMP_STACK_INFO */
 
+#ifdef CMB_USING_MPU_STACK_GUARD
+    /* the stacking is faulted on the stack guard, so the stack frame is invalid */
+    if (CMB_NVIC_MFSR & MPU_MFSR_MSTKERR) {
+        stack_is_overflow = true;
     }
+    /* the overflowed store is faulted on the guard of main stack or the faulted thread stack, or on the guard of
+     * switched out thread when its context is saved on PendSV (RT-Thread) */
+    if ((CMB_NVIC_MFSR & (MPU_MFSR_DACCVIOL | MPU_MFSR_MMARVALID)) == (MPU_MFSR_DACCVIOL | MPU_MFSR_MMARVALID)
+            && (mpu_stack_guard_hit(CMB_NVIC_MMAR, main_stack_start_addr)
+            || mpu_stack_guard_hit(CMB_NVIC_MMAR, fault_stack_start_addr)
+#if defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+            || mpu_stack_guard_hit(CMB_NVIC_MMAR, mpu_prev_guard_stack_start_addr)
+#endif
+            )) {
+        stack_is_overflow = true;
+    }
+#endif
 
-#else
+    fault_stack_pointer = stack_pointer;
+
+    /* the stack frame may be get failed when it is overflow  */
+    if (!stack_is_overflow) {
+        regs.saved.r0        = ((uint32_t *)saved_regs_addr)[0];  // Register R0
+        regs.saved.r1        = ((uint32_t *)saved_regs_addr)[1];  // Register R1
+        regs.saved.r2        = ((uint32_t *)saved_regs_addr)[2];  // Register R2
+        regs.saved.r3        = ((uint32_t *)saved_regs_addr)[3];  // Register R3
+        regs.saved.r12       = ((uint32_t *)saved_regs_addr)[4];  // Register R12
+        regs.saved.lr        = ((uint32_t *)saved_regs_addr)[5];  // Link register LR
+        regs.saved.pc        = ((uint32_t *)saved_regs_addr)[6];  // Program counter PC
+        regs.saved.psr.value = ((uint32_t *)saved_regs_addr)[7];  // Program status word PSR
+    }
+
+    /* the Cortex-M0 is not support fault diagnosis */
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+    regs.syshndctrl.value = CMB_SYSHND_CTRL;  // System Handler Control and State Register
+    regs.mfsr.value       = CMB_NVIC_MFSR;    // Memory Fault Status Register
+    regs.mmar             = CMB_NVIC_MMAR;    // Memory Management Fault Address Register
+    regs.bfsr.value       = CMB_NVIC_BFSR;    // Bus Fault Status Register
+    regs.bfar             = CMB_NVIC_BFAR;    // Bus Fault Manage Address Register
+    regs.ufsr.value       = CMB_NVIC_UFSR;    // Usage Fault Status Register
+    regs.hfsr.value       = CMB_NVIC_HFSR;    // Hard Fault Status Register
+    regs.dfsr.value       = CMB_NVIC_DFSR;    // Debug Fault Status Register
+    regs.afsr             = CMB_NVIC_AFSR;    // Auxiliary Fault Status Register
+#endif
+
+    PHASE_RECORD(CMB_PHASE_CAPTURE, start);
+
+    PHASE_START(start);
+    capture_call_stack(stack_pointer);
+    PHASE_RECORD(CMB_PHASE_STACK_SCAN, start);
+}
+
+/**
+ * print the captured fault information by priority, so the truncated report still has the critical data.
+ * order: signature, PC/LR, call stack, cause, registers, firmware information then the bulk stack data
+ */
+static void fault_report(void) {
+    const char *regs_name[] = { "R0 ", "R1 ", "R2 ", "R3 ", "R12", "LR ", "PC ", "PSR" };
+#ifdef CMB_USING_PHASE_TIMING
+    uint32_t report_start;
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0) || defined(CMB_USING_DUMP_STACK_INFO)
+    uint32_t start;
+#endif
+#endif
+
+    PHASE_START(report_start);
+
+    cmb_println("");
+    print_signature();
+    if (!stack_is_overflow) {
+        cmb_println(print_info[PRINT_FAULT_PC_LR], regs.saved.pc, regs.saved.lr);
+    }
+    print_call_stack();
+    cmb_wdt_feed();
 
+#ifdef CMB_USING_OS_PLATFORM
+    if (on_thread_before_fault) {
+        cmb_println(print_info[PRINT_FAULT_ON_THREAD], fault_thread_name != NULL ? fault_thread_name : "NO_NAME");
+    } else {
+        cmb_println(print_info[PRINT_FAULT_ON_HANDLER]);
+    }
+#else
     /* bare metal(no OS) environment */
+    cmb_println(print_info[PRINT_FAULT_ON_HANDLER]);
+#endif /* CMB_USING_OS_PLATFORM */
+
+    if (stack_is_overflow) {
+        if (on_thread_before_fault) {
+            cmb_println(print_info[PRINT_THREAD_STACK_OVERFLOW], fault_stack_pointer);
+        } else {
+            cmb_println(print_info[PRINT_MAIN_STACK_OVERFLOW], fault_stack_pointer);
+        }
+    }
+
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+    PHASE_START(start);
+    fault_diagnosis();
+    PHASE_RECORD(CMB_PHASE_DIAGNOSIS, start);
+#ifdef CMB_USING_HEAP_VERIFY
+    print_heap_fault_addr();
+#endif
+#endif
+#ifdef CMB_USING_STACK_OWNER
+    print_fault_stack_owner();
+#endif
+    cmb_wdt_feed();
+
+    /* the stack frame may be get failed when it is overflow  */
+    if (!stack_is_overflow) {
+        /* dump register */
+        cmb_println(print_info[PRINT_REGS_TITLE]);
+        cmb_println("  %s: %08x  %s: %08x  %s: %08x  %s: %08x", regs_name[0], regs.saved.r0,
+                                                                regs_name[1], regs.saved.r1,
+                                                                regs_name[2], regs.saved.r2,
+                                                                regs_name[3], regs.saved.r3);
+        cmb_println("  %s: %08x  %s: %08x  %s: %08x  %s: %08x", regs_name[4], regs.saved.r12,
+                                                                regs_name[5], regs.saved.lr,
+                                                                regs_name[6], regs.saved.pc,
+                                                                regs_name[7], regs.saved.psr.value);
+        cmb_println("==============================================================");
+    }
+
+    cm_backtrace_firmware_info();
+
+#ifdef CMB_USING_ALL_THREADS_BACKTRACE
+    cmb_wdt_feed();
+    cmb_println(print_info[PRINT_ALL_THREADS_TITLE]);
+    cm_backtrace_foreach_thread(print_thread_call_stack, NULL);
+#endif
+
+#ifdef CMB_USING_SWITCH_RECORDER
+    cmb_wdt_feed();
+    print_switch_recorder(PRINT_SWITCH_RECORDER_TITLE);
+#endif
+
+#ifdef CMB_USING_IRQ_RECORDER
+    cmb_wdt_feed();
+    print_irq_recorder(PRINT_IRQ_RECORDER_TITLE);
+#endif
+
+#ifdef CMB_USING_STACK_HWM
+    cmb_wdt_feed();
+    print_stack_hwm_table();
+#endif
+
 #ifdef CMB_USING_DUMP_STACK_INFO
-    dump_stack(main_stack_start_addr, main_stack_size, (uint32_t *) sp);
+    cmb_wdt_feed();
+    PHASE_START(start);
+    dump_stack(fault_stack_start_addr, fault_stack_size, (uint32_t *) fault_stack_pointer);
+    PHASE_RECORD(CMB_PHASE_DUMP_STACK, start);
 #endif /* CMB_USING_DUMP_STACK_INFO */
 
-#endif /* CMB_USING_OS_PLATFORM */
+    PHASE_RECORD(CMB_PHASE_REPORT, report_start);
+#if defined(CMB_USING_PHASE_TIMING) && defined(CMB_PHASE_TIMING_ON_REPORT)
+    print_phase_timing();
+#endif
+}
+
+#if defined(CMB_USING_DEFERRED_REPORT) || defined(CMB_USING_THREAD_FAULT_RECOVERY)
+/**
+ * redirect the faulted code to the function, it will be run when the fault handler returns
+ *
+ * @param fault_handler_sp the stack pointer on fault handler
+ * @param func the function which never returns
+ */
+static void fault_redirect(uint32_t fault_handler_sp, void (*func)(void)) {
+    uint32_t *frame = (uint32_t *) fault_handler_sp;
+
+#ifdef CMB_USING_OS_PLATFORM
+    if (on_thread_before_fault) {
+        frame = (uint32_t *) cmb_get_psp();
+    }
+#endif
+    /* the stacked PC and xPSR, the alignment bit is kept so the stack pointer is restored correctly */
+    frame[6] = (uint32_t) func & ~1UL;
+    frame[7] = FAULT_RETURN_PSR | (frame[7] & FAULT_RETURN_PSR_ALIGN);
+}
+#endif /* defined(CMB_USING_DEFERRED_REPORT) || defined(CMB_USING_THREAD_FAULT_RECOVERY) */
 
-    print_call_stack(sp);
+#ifdef CMB_USING_DEFERRED_REPORT
+/**
+ * the faulted thread will be returned to here, the lower priority interrupts still can be run
+ */
+static void fault_safe_loop(void) {
+    while (1);
+}
+
+/**
+ * redirect the faulted code to the safe loop and trigger the deferred report interrupt
+ *
+ * @param fault_handler_lr the LR register value on fault handler
+ * @param fault_handler_sp the stack pointer on fault handler
+ *
+ * @return false: the fault can't be deferred, it must be reported on the fault handler
+ */
+static bool fault_defer(uint32_t fault_handler_lr, uint32_t fault_handler_sp) {
+    /* the fault on handler mode will block the report interrupt, and the frame is untrusted when stack is overflow */
+    if (!(fault_handler_lr & (1UL << 3)) || stack_is_overflow) {
+        return false;
+    }
+    fault_redirect(fault_handler_sp, fault_safe_loop);
+
+    report_pending = true;
+    CMB_DEFERRED_REPORT_TRIGGER();
+
+    return true;
+}
+
+/**
+ * print the deferred fault report, it should be called on the interrupt which is triggered by
+ * CMB_DEFERRED_REPORT_TRIGGER (e.g., PendSV_Handler on bare metal), it does nothing when no fault report (or stack
+ * overflow record by CMB_USING_STACK_CHECK) is pending
+ */
+void cm_backtrace_fault_report(void) {
+#ifdef CMB_USING_STACK_CHECK
+    /* the stack overflow which is recorded on context switch is printed on the same deferred report interrupt */
+    cm_backtrace_stack_overflow_report();
+#endif
+
+    if (report_pending) {
+        report_pending = false;
+        fault_report();
+#ifdef CMB_USING_THREAD_FAULT_RECOVERY
+        if (thread_fault_recovering) {
+            /* the faulted thread is returned to thread_fault_exit after this interrupt, next fault can be captured */
+            thread_fault_recovering = false;
+            on_fault = false;
+        }
+#endif
+    }
+}
+#endif /* CMB_USING_DEFERRED_REPORT */
+
+#ifdef CMB_USING_THREAD_FAULT_RECOVERY
+/**
+ * set the hook which is called on the faulted thread before it is suspended or deleted, e.g., restart the service
+ * by a new thread. the hook is called on the faulted thread context, so it can't be blocked.
+ *
+ * @param hook the hook, thread: the faulted thread control block, signature: the crash signature
+ */
+void cm_backtrace_thread_fault_sethook(void (*hook)(void *thread, uint32_t signature)) {
+    thread_fault_hook = hook;
+}
+
+/**
+ * check the current thread is the OS idle thread, it can't be suspended or deleted
+ */
+static bool thread_fault_on_idle(void) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    return !rt_strncmp(rt_thread_self()->name, "tidle", RT_NAME_MAX);
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    extern INT8U OSPrioCur;
+
+    return OSPrioCur == OS_TASK_IDLE_PRIO;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    extern OS_TCB *OSTCBCurPtr;
+    extern OS_TCB OSIdleTaskTCB;
+
+    return OSTCBCurPtr == &OSIdleTaskTCB;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+#if (INCLUDE_xTaskGetIdleTaskHandle == 1)
+    return xTaskGetCurrentTaskHandle() == xTaskGetIdleTaskHandle();
+#else
+    return !strncmp(pcTaskGetName(NULL), "IDLE", configMAX_TASK_NAME_LEN);
+#endif
+#endif
+}
+
+/**
+ * check the captured fault is recoverable by suspending or deleting the faulted thread
+ *
+ * @param fault_handler_lr the LR register value on fault handler
+ *
+ * @return true: the OS is consistent and only the faulted thread is broken
+ */
+static bool thread_fault_recoverable(uint32_t fault_handler_lr) {
+    uint32_t frame = cmb_get_psp();
+
+    /* only the fault on thread mode which uses PSP, the OS state is unknown when it is faulted on interrupt */
+    if (!(fault_handler_lr & (1UL << 3)) || !on_thread_before_fault) {
+        return false;
+    }
+    /* the stacked frame is untrusted when the thread stack is overflow */
+    if (stack_is_overflow || frame < fault_stack_start_addr
+            || fault_stack_pointer > fault_stack_start_addr + fault_stack_size) {
+        return false;
+    }
+    /* the OS state may be inconsistent when it is faulted on critical section (include escalated to HardFault) */
+    if ((cmb_get_primask() & 1UL) || cmb_get_basepri()) {
+        return false;
+    }
+    /* the faulted thread can't be switched out when the scheduler is locked */
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    if (rt_critical_level()) {
+        return false;
+    }
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    {
+        extern INT8U OSLockNesting;
+
+        if (OSLockNesting) {
+            return false;
+        }
+    }
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    {
+        extern OS_NESTING_CTR OSSchedLockNestingCtr;
+
+        if (OSSchedLockNestingCtr) {
+            return false;
+        }
+    }
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+#if (INCLUDE_xTaskGetSchedulerState == 1) || (configUSE_TIMERS == 1)
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return false;
+    }
+#endif
+#endif
+
+    return !thread_fault_on_idle();
 }
 
-#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
 /**
- * fault diagnosis then print cause of fault
+ * the faulted thread will be returned to here after the fault report, it calls the hook then suspends or deletes
+ * itself by OS, the other threads keep running
  */
-static void fault_diagnosis(void) {
-    if (regs.hfsr.bits.VECTBL) {
-        cmb_println(print_info[PRINT_HFSR_VECTBL]);
-    }
-    if (regs.hfsr.bits.FORCED) {
-        /* Memory Management Fault */
-        if (regs.mfsr.value) {
-            if (regs.mfsr.bits.IACCVIOL) {
-                cmb_println(print_info[PRINT_MFSR_IACCVIOL]);
-            }
-            if (regs.mfsr.bits.DACCVIOL) {
-                cmb_println(print_info[PRINT_MFSR_DACCVIOL]);
-            }
-            if (regs.mfsr.bits.MUNSTKERR) {
-                cmb_println(print_info[PRINT_MFSR_MUNSTKERR]);
-            }
-            if (regs.mfsr.bits.MSTKERR) {
-                cmb_println(print_info[PRINT_MFSR_MSTKERR]);
-            }
+static void thread_fault_exit(void) {
+    const char *name = get_cur_thread_name();
+    void *thread;
 
-#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
-            if (regs.mfsr.bits.MLSPERR) {
-                cmb_println(print_info[PRINT_MFSR_MLSPERR]);
-            }
-#endif
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+    thread = rt_thread_self();
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+    extern OS_TCB *OSTCBCur;
 
-            if (regs.mfsr.bits.MMARVALID) {
-                if (regs.mfsr.bits.IACCVIOL || regs.mfsr.bits.DACCVIOL) {
-                    cmb_println(print_info[PRINT_MMAR], regs.mmar);
-                }
-            }
-        }
-        /* Bus Fault */
-        if (regs.bfsr.value) {
-            if (regs.bfsr.bits.IBUSERR) {
-                cmb_println(print_info[PRINT_BFSR_IBUSERR]);
-            }
-            if (regs.bfsr.bits.PRECISERR) {
-                cmb_println(print_info[PRINT_BFSR_PRECISERR]);
-            }
-            if (regs.bfsr.bits.IMPREISERR) {
-                cmb_println(print_info[PRINT_BFSR_IMPREISERR]);
-            }
-            if (regs.bfsr.bits.UNSTKERR) {
-                cmb_println(print_info[PRINT_BFSR_UNSTKERR]);
-            }
-            if (regs.bfsr.bits.STKERR) {
-                cmb_println(print_info[PRINT_BFSR_STKERR]);
-            }
+    thread = OSTCBCur;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+    extern OS_TCB *OSTCBCurPtr;
 
-#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
-            if (regs.bfsr.bits.LSPERR) {
-                cmb_println(print_info[PRINT_BFSR_LSPERR]);
-            }
+    thread = OSTCBCurPtr;
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+    thread = xTaskGetCurrentTaskHandle();
 #endif
 
-            if (regs.bfsr.bits.BFARVALID) {
-                if (regs.bfsr.bits.PRECISERR) {
-                    cmb_println(print_info[PRINT_BFAR], regs.bfar);
-                }
-            }
+    cmb_println(print_info[PRINT_THREAD_FAULT_RECOVERED], name != NULL ? name : "NO_NAME");
+    if (thread_fault_hook) {
+        thread_fault_hook(thread, last_signature);
+    }
 
+    /* the suspended thread is suspended again when it is resumed, because its context was broken by fault */
+    while (1) {
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+#if (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_SUSPEND)
+        rt_thread_suspend((rt_thread_t) thread);
+#elif defined(RT_USING_HEAP)
+        if (rt_object_is_systemobject((rt_object_t) thread)) {
+            rt_thread_detach((rt_thread_t) thread);
+        } else {
+            rt_thread_delete((rt_thread_t) thread);
         }
-        /* Usage Fault */
-        if (regs.ufsr.value) {
-            if (regs.ufsr.bits.UNDEFINSTR) {
-                cmb_println(print_info[PRINT_UFSR_UNDEFINSTR]);
-            }
-            if (regs.ufsr.bits.INVSTATE) {
-                cmb_println(print_info[PRINT_UFSR_INVSTATE]);
-            }
-            if (regs.ufsr.bits.INVPC) {
-                cmb_println(print_info[PRINT_UFSR_INVPC]);
-            }
-            if (regs.ufsr.bits.NOCP) {
-                cmb_println(print_info[PRINT_UFSR_NOCP]);
-            }
-            if (regs.ufsr.bits.UNALIGNED) {
-                cmb_println(print_info[PRINT_UFSR_UNALIGNED]);
-            }
-            if (regs.ufsr.bits.DIVBYZERO0) {
-                cmb_println(print_info[PRINT_UFSR_DIVBYZERO0]);
-            }
-        }
-    }
-    /* Debug Fault */
-    if (regs.hfsr.bits.DEBUGEVT) {
-        if (regs.dfsr.value) {
-            if (regs.dfsr.bits.HALTED) {
-                cmb_println(print_info[PRINT_DFSR_HALTED]);
-            }
-            if (regs.dfsr.bits.BKPT) {
-                cmb_println(print_info[PRINT_DFSR_BKPT]);
-            }
-            if (regs.dfsr.bits.DWTTRAP) {
-                cmb_println(print_info[PRINT_DFSR_DWTTRAP]);
-            }
-            if (regs.dfsr.bits.VCATCH) {
-                cmb_println(print_info[PRINT_DFSR_VCATCH]);
-            }
-            if (regs.dfsr.bits.EXTERNAL) {
-                cmb_println(print_info[PRINT_DFSR_EXTERNAL]);
-            }
+#else
+        rt_thread_detach((rt_thread_t) thread);
+#endif
+        rt_schedule();
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII)
+#if (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_SUSPEND)
+        OSTaskSuspend(OS_PRIO_SELF);
+#else
+        OSTaskDel(OS_PRIO_SELF);
+#endif
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+        {
+            OS_ERR err;
+#if (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_SUSPEND)
+            OSTaskSuspend(NULL, &err);
+#else
+            OSTaskDel(NULL, &err);
+#endif
         }
+#elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+#if (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_SUSPEND)
+        vTaskSuspend(NULL);
+#else
+        vTaskDelete(NULL);
+#endif
+#endif
     }
 }
-#endif /* (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0) */
 
-#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
-static uint32_t statck_del_fpu_regs(uint32_t fault_handler_lr, uint32_t sp) {
-    statck_has_fpu_regs = (fault_handler_lr & (1UL << 4)) == 0 ? true : false;
+/**
+ * recover from the fault on thread, the faulted thread is redirected to thread_fault_exit and the fault handler
+ * returns to the scheduler
+ *
+ * @param fault_handler_lr the LR register value on fault handler
+ * @param fault_handler_sp the stack pointer on fault handler
+ *
+ * @return false: the fault isn't recoverable, the system must be halted
+ */
+static bool thread_fault_recover(uint32_t fault_handler_lr, uint32_t fault_handler_sp) {
+    if (!thread_fault_recoverable(fault_handler_lr)) {
+        return false;
+    }
+    fault_redirect(fault_handler_sp, thread_fault_exit);
 
-    /* the stack has S0~S15 and FPSCR registers when statck_has_fpu_regs is true, double word align */
-    return statck_has_fpu_regs == true ? sp + sizeof(size_t) * 18 : sp;
-}
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+    /* the fault status bits are sticky (write 1 to clear), so the next fault isn't diagnosed with the stale bits */
+    CMB_NVIC_MFSR = regs.mfsr.value;
+    CMB_NVIC_BFSR = regs.bfsr.value;
+    CMB_NVIC_UFSR = regs.ufsr.value;
+    CMB_NVIC_HFSR = regs.hfsr.value;
+#endif
+
+#ifdef CMB_USING_DEFERRED_REPORT
+    /* the report interrupt preempts the faulted thread, the fault is released after it is printed */
+    thread_fault_recovering = true;
+    report_pending = true;
+    CMB_DEFERRED_REPORT_TRIGGER();
+#else
+    fault_report();
+    on_fault = false;
 #endif
 
+    return true;
+}
+#endif /* CMB_USING_THREAD_FAULT_RECOVERY */
+
 /**
  * backtrace for fault
- * @note only call once
+ * @note only call once, except the recovered fault on thread by CMB_USING_THREAD_FAULT_RECOVERY
+ * @note it only returns when the report is deferred by CMB_USING_DEFERRED_REPORT or the faulted thread is recovered
+ *       by CMB_USING_THREAD_FAULT_RECOVERY, then the fault handler must return by the fault_handler_lr
  *
  * @param fault_handler_lr the LR register value on fault handler
  * @param fault_handler_sp the stack pointer on fault handler
  */
 void cm_backtrace_fault(uint32_t fault_handler_lr, uint32_t fault_handler_sp) {
-    uint32_t stack_pointer = fault_handler_sp, saved_regs_addr = stack_pointer;
-    const char *regs_name[] = { "R0 ", "R1 ", "R2 ", "R3 ", "R12", "LR ", "PC ", "PSR" };
-
-#ifdef CMB_USING_DUMP_STACK_INFO
-    uint32_t stack_start_addr = main_stack_start_addr;
-    size_t stack_size = main_stack_size;
-#endif
-
     CMB_ASSERT(init_ok);
     /* only call once */
     CMB_ASSERT(!on_fault);
 
     on_fault = true;
 
-    cmb_println("");
-    cm_backtrace_firmware_info();
+    fault_capture(fault_handler_lr, fault_handler_sp);
 
-#ifdef CMB_USING_OS_PLATFORM
-    on_thread_before_fault = fault_handler_lr & (1UL << 2);
-    /* check which stack was used before (MSP or PSP) */
-    if (on_thread_before_fault) {
-        cmb_println(print_info[PRINT_FAULT_ON_THREAD], get_cur_thread_name() != NULL ? get_cur_thread_name() : "NO_NAME");
-        saved_regs_addr = stack_pointer = cmb_get_psp();
+#ifdef CMB_USING_THREAD_FAULT_RECOVERY
+    if (thread_fault_recover(fault_handler_lr, fault_handler_sp)) {
+        return;
+    }
+#endif
 
-#ifdef CMB_USING_DUMP_STACK_INFO
-        get_cur_thread_stack_info(stack_pointer, &stack_start_addr, &stack_size);
-#endif /* CMB_USING_DUMP_STACK_INFO */
+#ifdef CMB_USING_DEFERRED_REPORT
+    if (fault_defer(fault_handler_lr, fault_handler_sp)) {
+        return;
+    }
+#endif
+
+    fault_report();
+#if defined(CMB_USING_DEFERRED_REPORT) || defined(CMB_USING_THREAD_FAULT_RECOVERY)
+    /* the fault handler will return to the faulted code when this function returns */
+    while (1);
+#endif
+}
+
+#if defined(CMB_USING_ALL_THREADS_BACKTRACE) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH) \
+        && defined(RT_USING_HEAP)
+/* the call stack snapshot of one thread which is taken on scheduler locked */
+struct thread_bt_record {
+    char name[RT_NAME_MAX + 1];
+    size_t depth;
+    uint32_t call_stack[CMB_CALL_STACK_MAX_DEPTH];
+};
 
+struct thread_bt_snapshot {
+    const char *name;                  /* the target thread name, NULL: all threads */
+    struct thread_bt_record *records;
+    size_t size;
+    size_t num;
+};
+
+static void thread_bt_take(const struct cmb_thread_info *thread, void *arg) {
+    struct thread_bt_snapshot *snapshot = (struct thread_bt_snapshot *) arg;
+    struct thread_bt_record *record;
+
+    if (snapshot->num >= snapshot->size || (snapshot->name && rt_strncmp(thread->name, snapshot->name, RT_NAME_MAX))) {
+        return;
+    }
+
+    record = &snapshot->records[snapshot->num++];
+    rt_strncpy(record->name, thread->name, RT_NAME_MAX);
+    record->name[RT_NAME_MAX] = '\0';
+    record->depth = cm_backtrace_thread_call_stack(thread, record->call_stack, CMB_CALL_STACK_MAX_DEPTH);
+}
+
+/**
+ * backtrace the running system threads without fault, the scheduler is only locked on taking the snapshot,
+ * the locked time is limited by CMB_THREAD_MAX_NUM and CMB_THREAD_STACK_SCAN_MAX_WORDS
+ *
+ * usage: cmb_bt [thread|all]
+ */
+static void cmb_bt(uint8_t argc, char **argv) {
+    struct thread_bt_snapshot snapshot = { NULL, NULL, 0, 0 };
+    size_t i;
+
+    if (!init_ok) {
+        rt_kprintf("Please initialize the CmBacktrace by cm_backtrace_init.\n");
+        return;
+    }
+    if (argc > 1 && rt_strncmp(argv[1], "all", sizeof("all")) != 0) {
+        snapshot.name = argv[1];
+    }
+
+    /* the threads which are created after counting are ignored */
+    snapshot.size = snapshot.name ? 1 : cm_backtrace_foreach_thread(NULL, NULL);
+    snapshot.records = (struct thread_bt_record *) rt_malloc(snapshot.size * sizeof(struct thread_bt_record));
+    if (snapshot.records == NULL) {
+        rt_kprintf("Backtrace failed, no memory for %d threads.\n", snapshot.size);
+        return;
+    }
+
+    rt_enter_critical();
+    cm_backtrace_foreach_thread(thread_bt_take, &snapshot);
+    rt_exit_critical();
+
+    if (snapshot.num) {
+        cmb_println(print_info[PRINT_ALL_THREADS_TITLE]);
+        for (i = 0; i < snapshot.num; i++) {
+            print_thread_call_stack_info(snapshot.records[i].name, snapshot.records[i].call_stack,
+                    snapshot.records[i].depth);
+        }
     } else {
-        cmb_println(print_info[PRINT_FAULT_ON_HANDLER]);
+        rt_kprintf("Thread %s not found.\n", snapshot.name);
     }
-#else
-    /* bare metal(no OS) environment */
-    cmb_println(print_info[PRINT_FAULT_ON_HANDLER]);
-#endif /* CMB_USING_OS_PLATFORM */
 
-    /* delete saved R0~R3, R12, LR,PC,xPSR registers space */
-    stack_pointer += sizeof(size_t) * 8;
+    rt_free(snapshot.records);
+}
+MSH_CMD_EXPORT(cmb_bt, Backtrace the thread or all threads: cmb_bt [thread|all]);
+#endif /* defined(CMB_USING_ALL_THREADS_BACKTRACE) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) ... */
 
-#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7)
-    stack_pointer = statck_del_fpu_regs(fault_handler_lr, stack_pointer);
-#endif /* (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M4) || (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M7) */
+#if defined(CMB_USING_PROFILER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH)
+/**
+ * control the sampling profiler
+ *
+ * usage: cmb_prof <start|stop|dump>
+ */
+static void cmb_prof(uint8_t argc, char **argv) {
+    if (argc < 2) {
+        rt_kprintf("Usage: cmb_prof <start|stop|dump>\n");
+    } else if (!rt_strncmp(argv[1], "start", sizeof("start"))) {
+        cm_backtrace_profiler_start();
+    } else if (!rt_strncmp(argv[1], "stop", sizeof("stop"))) {
+        cm_backtrace_profiler_stop();
+    } else if (!rt_strncmp(argv[1], "dump", sizeof("dump"))) {
+        cm_backtrace_profiler_dump();
+    } else {
+        rt_kprintf("Usage: cmb_prof <start|stop|dump>\n");
+    }
+}
+MSH_CMD_EXPORT(cmb_prof, Sampling profiler: cmb_prof <start|stop|dump>);
+#endif /* defined(CMB_USING_PROFILER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH) */
 
-#ifdef CMB_USING_DUMP_STACK_INFO
-    /* check stack overflow */
-    if (stack_pointer < stack_start_addr || stack_pointer > stack_start_addr + stack_size) {
-        stack_is_overflow = true;
+#if defined(CMB_USING_IPC_PROFILER) && defined(RT_USING_FINSH)
+/**
+ * dump or clear the IPC contention profiler
+ *
+ * usage: cmb_ipc [top|clear]
+ */
+static void cmb_ipc(uint8_t argc, char **argv) {
+    if (argc < 2) {
+        cm_backtrace_ipc_profiler_dump(0);
+    } else if (!rt_strncmp(argv[1], "clear", sizeof("clear"))) {
+        cm_backtrace_ipc_profiler_clear();
+    } else {
+        cm_backtrace_ipc_profiler_dump(atoi(argv[1]));
     }
-    /* dump stack information */
-    dump_stack(stack_start_addr, stack_size, (uint32_t *) stack_pointer);
-#endif /* CMB_USING_DUMP_STACK_INFO */
+}
+MSH_CMD_EXPORT(cmb_ipc, IPC contention profiler: cmb_ipc [top|clear]);
+#endif /* defined(CMB_USING_IPC_PROFILER) && defined(RT_USING_FINSH) */
 
-    /* the stack frame may be get failed when it is overflow  */
-    if (!stack_is_overflow) {
-        /* dump register */
-        cmb_println(print_info[PRINT_REGS_TITLE]);
+#if defined(CMB_USING_HEAP_TRACKER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH)
+/**
+ * dump the top heap allocation sites
+ *
+ * usage: cmb_heap [top]
+ */
+static void cmb_heap(uint8_t argc, char **argv) {
+    cm_backtrace_heap_dump(argc < 2 ? 0 : atoi(argv[1]));
+}
+MSH_CMD_EXPORT(cmb_heap, Heap allocation sites: cmb_heap [top]);
+#endif /* defined(CMB_USING_HEAP_TRACKER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH) */
 
-        regs.saved.r0        = ((uint32_t *)saved_regs_addr)[0];  // Register R0
-        regs.saved.r1        = ((uint32_t *)saved_regs_addr)[1];  // Register R1
-        regs.saved.r2        = ((uint32_t *)saved_regs_addr)[2];  // Register R2
-        regs.saved.r3        = ((uint32_t *)saved_regs_addr)[3];  // Register R3
-        regs.saved.r12       = ((uint32_t *)saved_regs_addr)[4];  // Register R12
-        regs.saved.lr        = ((uint32_t *)saved_regs_addr)[5];  // Link register LR
-        regs.saved.pc        = ((uint32_t *)saved_regs_addr)[6];  // Program counter PC
-        regs.saved.psr.value = ((uint32_t *)saved_regs_addr)[7];  // Program status word PSR
+#if defined(CMB_USING_SHADOW_STACK) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH)
+/**
+ * benchmark the overhead of shadow call stack, the shell thread uses a temporary one when it has no shadow call stack
+ *
+ * usage: cmb_shadow [count]
+ */
+static void cmb_shadow(uint8_t argc, char **argv) {
+    static struct cmb_shadow_stack bench_stack;
+    rt_thread_t thread = rt_thread_self();
+    bool temporary = (thread->user_data == 0);
+    size_t count = argc < 2 ? 1000 : atoi(argv[1]);
+    uint32_t overhead;
 
-        cmb_println("  %s: %08x  %s: %08x  %s: %08x  %s: %08x", regs_name[0], regs.saved.r0,
-                                                                regs_name[1], regs.saved.r1,
-                                                                regs_name[2], regs.saved.r2,
-                                                                regs_name[3], regs.saved.r3);
-        cmb_println("  %s: %08x  %s: %08x  %s: %08x  %s: %08x", regs_name[4], regs.saved.r12,
-                                                                regs_name[5], regs.saved.lr,
-                                                                regs_name[6], regs.saved.pc,
-                                                                regs_name[7], regs.saved.psr.value);
-        cmb_println("==============================================================");
+    if (count == 0) {
+        rt_kprintf("Usage: cmb_shadow [count]\n");
+        return;
     }
+    if (temporary) {
+        cm_backtrace_shadow_stack_set(thread, &bench_stack);
+    }
+    overhead = cm_backtrace_shadow_stack_bench(count);
+    if (temporary) {
+        cm_backtrace_shadow_stack_set(thread, NULL);
+    }
+    rt_kprintf("Shadow call stack overhead: %d per function entry and exit (%d calls)\n", overhead, count);
+}
+MSH_CMD_EXPORT(cmb_shadow, Shadow call stack benchmark: cmb_shadow [count]);
+#endif /* defined(CMB_USING_SHADOW_STACK) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH) */
 
-    /* the Cortex-M0 is not support fault diagnosis */
-#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
-    regs.syshndctrl.value = CMB_SYSHND_CTRL;  // System Handler Control and State Register
-    regs.mfsr.value       = CMB_NVIC_MFSR;    // Memory Fault Status Register
-    regs.mmar             = CMB_NVIC_MMAR;    // Memory Management Fault Address Register
-    regs.bfsr.value       = CMB_NVIC_BFSR;    // Bus Fault Status Register
-    regs.bfar             = CMB_NVIC_BFAR;    // Bus Fault Manage Address Register
-    regs.ufsr.value       = CMB_NVIC_UFSR;    // Usage Fault Status Register
-    regs.hfsr.value       = CMB_NVIC_HFSR;    // Hard Fault Status Register
-    regs.dfsr.value       = CMB_NVIC_DFSR;    // Debug Fault Status Register
-    regs.afsr             = CMB_NVIC_AFSR;    // Auxiliary Fault Status Register
+#if defined(CMB_USING_STACK_OWNER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH)
+/**
+ * find the stack owner of the address
+ *
+ * usage: cmb_owner addr
+ */
+static void cmb_owner(uint8_t argc, char **argv) {
+    struct cmb_stack_owner owner;
+    char name[RT_NAME_MAX];
+    uint32_t addr;
+    bool found;
 
-    fault_diagnosis();
-#endif
+    if (argc < 2) {
+        rt_kprintf("Usage: cmb_owner addr\n");
+        return;
+    }
+    addr = strtoul(argv[1], NULL, 16);
+    /* the owner thread can't be deleted on scheduler locked, so its name is copied before printing */
+    rt_enter_critical();
+    found = cm_backtrace_stack_owner(addr, &owner);
+    if (found && owner.thread) {
+        rt_strncpy(name, ((struct rt_thread *) owner.thread)->name, RT_NAME_MAX);
+    }
+    rt_exit_critical();
 
-    print_call_stack(stack_pointer);
+    if (!found) {
+        rt_kprintf("%08x isn't on any stack\n", addr);
+        if (stack_owner_dropped) {
+            rt_kprintf("%d threads aren't on the stack owner index, it's full\n", stack_owner_dropped);
+        }
+    } else if (owner.thread == 0) {
+        rt_kprintf("%08x is on the main stack (%08x - %08x)\n", addr, owner.start_addr, owner.end_addr);
+    } else {
+        rt_kprintf("%08x is on the stack of thread %.*s (%08x - %08x)\n", addr, RT_NAME_MAX, name, owner.start_addr,
+                owner.end_addr);
+    }
 }
+MSH_CMD_EXPORT(cmb_owner, Stack owner of address: cmb_owner addr);
+#endif /* defined(CMB_USING_STACK_OWNER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && defined(RT_USING_FINSH) */
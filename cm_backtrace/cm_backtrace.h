@@ -36,5 +36,123 @@ void cm_backtrace_firmware_info(void);
 size_t cm_backtrace_call_stack(uint32_t *buffer, size_t size, uint32_t sp);
 void cm_backtrace_assert(uint32_t sp);
 void cm_backtrace_fault(uint32_t fault_handler_lr, uint32_t fault_handler_sp);
+#ifdef CMB_USING_DEFERRED_REPORT
+void cm_backtrace_fault_report(void);
+#endif
+#ifdef CMB_USING_THREAD_FAULT_RECOVERY
+void cm_backtrace_thread_fault_sethook(void (*hook)(void *thread, uint32_t signature));
+#endif
+#if defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+void cm_backtrace_freertos_task_create(void *task);
+void cm_backtrace_freertos_task_delete(void *task);
+void cm_backtrace_freertos_task_switched_in(void *task);
+#endif
+#ifdef CMB_USING_THREAD_WALK
+size_t cm_backtrace_foreach_thread(void (*callback)(const struct cmb_thread_info *thread, void *arg), void *arg);
+#endif
+#ifdef CMB_USING_ALL_THREADS_BACKTRACE
+size_t cm_backtrace_thread_call_stack(const struct cmb_thread_info *thread, uint32_t *buffer, size_t size);
+#endif
+#ifdef CMB_USING_STACK_HWM
+size_t cm_backtrace_stack_hwm(uint32_t stack_start_addr, size_t stack_size, uint32_t paint);
+size_t cm_backtrace_stack_hwm_check(void);
+#endif
+#ifdef CMB_USING_SWITCH_RECORDER
+const struct cmb_switch_recorder *cm_backtrace_switch_recorder(void);
+#endif
+#if (defined(CMB_USING_SWITCH_RECORDER) || defined(CMB_USING_MPU_STACK_GUARD) || defined(CMB_USING_STACK_CHECK)) \
+        && defined(CMB_USING_OS_PLATFORM) && ((CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII) || (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII))
+void cm_backtrace_task_sw_hook(void);
+#endif
+#ifdef CMB_USING_STACK_OWNER
+bool cm_backtrace_stack_owner(uint32_t addr, struct cmb_stack_owner *owner);
+#if (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII) || (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+void cm_backtrace_task_create_hook(void *tcb);
+void cm_backtrace_task_del_hook(void *tcb);
+#endif
+#endif
+#ifdef CMB_USING_STACK_CHECK
+void cm_backtrace_stack_overflow(void *thread);
+void cm_backtrace_stack_overflow_report(void);
+void cm_backtrace_stack_overflow_sethook(void (*hook)(const struct cmb_stack_overflow_record *record));
+const struct cmb_stack_overflow_record *cm_backtrace_stack_overflow_record(void);
+#endif
+#ifdef CMB_USING_IRQ_RECORDER
+void cm_backtrace_irq_record(uint32_t exc_return, uint32_t msp, uint32_t exception);
+const struct cmb_irq_recorder *cm_backtrace_irq_recorder(void);
+#endif
+#ifdef CMB_USING_HANG_CAPTURE
+void cm_backtrace_hang(void);
+const struct cmb_hang_record *cm_backtrace_hang_record(void);
+#endif
+#ifdef CMB_USING_TICK_SAMPLER
+void cm_backtrace_tick_sample(void);
+const struct cmb_tick_sampler *cm_backtrace_tick_sampler(void);
+#endif
+#ifdef CMB_USING_PROFILER
+void cm_backtrace_profiler_start(void);
+void cm_backtrace_profiler_stop(void);
+void cm_backtrace_profiler_sample(void);
+void cm_backtrace_profiler_dump(void);
+#endif
+#ifdef CMB_USING_IPC_PROFILER
+void cm_backtrace_ipc_profiler_clear(void);
+void cm_backtrace_ipc_profiler_dump(size_t top);
+#endif
+#ifdef CMB_USING_HEAP_TRACKER
+void cm_backtrace_heap_alloc(void *ptr, size_t size);
+void cm_backtrace_heap_free(void *ptr);
+void cm_backtrace_heap_dump(size_t top);
+#endif
+#ifdef CMB_USING_HEAP_VERIFY
+size_t cm_backtrace_heap_verify_add(const void *begin_addr, const void *end_addr);
+uint32_t cm_backtrace_heap_verify(void);
+#endif
+#ifdef CMB_USING_SOFT_ASSERT
+void cm_backtrace_soft_assert(uint32_t site, uint32_t sp);
+size_t cm_backtrace_soft_assert_drain(void);
+#endif
+#ifdef CMB_USING_ASSERT_REGISTRY
+size_t cm_backtrace_assert_site_hit(const struct cmb_assert_site *site);
+void cm_backtrace_assert_site(const struct cmb_assert_site *site, uint32_t sp);
+void cm_backtrace_assert_site_dump(void);
+#endif
+#ifdef CMB_USING_PHASE_TIMING
+const struct cmb_phase_timing *cm_backtrace_phase_timing(void);
+void cm_backtrace_phase_timing_clear(void);
+#endif
+#ifdef CMB_USING_SHADOW_STACK
+#ifdef CMB_USING_OS_PLATFORM
+void cm_backtrace_shadow_stack_set(void *thread, struct cmb_shadow_stack *stack);
+#endif
+uint32_t cm_backtrace_shadow_stack_bench(size_t count);
+#endif
+uint32_t cm_backtrace_stack_hash(const uint32_t *buffer, size_t depth);
+uint32_t cm_backtrace_signature(void);
+
+#ifdef CMB_USING_BKP_RECORD
+const struct cmb_bkp_record *cm_backtrace_bkp_record(void);
+#endif
+
+#ifdef CMB_USING_SIG_TABLE
+const struct cmb_sig_table *cm_backtrace_sig_table(void);
+void cm_backtrace_sig_table_clear(void);
+#endif
+
+#ifdef CMB_USING_ASSERT_REGISTRY
+/* the file ID of assert sites, it should be defined before including this file on each source file */
+#ifndef CMB_ASSERT_FILE_ID
+#define CMB_ASSERT_FILE_ID             0
+#endif
+
+/* assert with site registry, the site is counted then reported by soft assert (CMB_USING_SOFT_ASSERT) or assert */
+#define CMB_SITE_ASSERT(EXPR)                                                  \
+do {                                                                           \
+    if (!(EXPR)) {                                                             \
+        CMB_ASSERT_SITE_DEFINE(_cmb_assert_site, CMB_ASSERT_FILE_ID);          \
+        cm_backtrace_assert_site(&_cmb_assert_site, cmb_get_sp());             \
+    }                                                                          \
+} while (0)
+#endif
 
 #endif /* _CORTEXM_BACKTRACE_H_ */
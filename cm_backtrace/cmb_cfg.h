@@ -31,6 +31,8 @@
 
 /* print line, must config by user */
 #define cmb_println(...)               /* e.g., printf(__VA_ARGS__);printf("\r\n") */
+/* feed the watchdog on printing the report, it is optional */
+/* #define cmb_wdt_feed()                 e.g., IWDG_ReloadCounter() */
 /* enable bare metal(no OS) platform */
 /* #define CMB_USING_BARE_METAL_PLATFORM */
 /* enable OS platform */
@@ -41,6 +43,121 @@
 #define CMB_CPU_PLATFORM_TYPE          /* CMB_CPU_ARM_CORTEX_M0 or CMB_CPU_ARM_CORTEX_M3 or CMB_CPU_ARM_CORTEX_M4 or CMB_CPU_ARM_CORTEX_M7 */
 /* enable dump stack information */
 /* #define CMB_USING_DUMP_STACK_INFO */
+/* enable the dedicated MemManage, BusFault and UsageFault handlers, it must be defined on assembler too when using cmb_fault.S */
+/* #define CMB_USING_CONFIGURABLE_FAULT */
+/* priority register value of the configurable fault handlers, must config when CMB_USING_CONFIGURABLE_FAULT is enable,
+ * the interrupts which must keep running on fault should have higher priority (lower value) than it */
+/* #define CMB_CONFIGURABLE_FAULT_PRIORITY  e.g., (2 << (8 - __NVIC_PRIO_BITS)) */
+/* enable deferred fault report, the fault handler only captures and the report is printed by cm_backtrace_fault_report()
+ * on a lowest priority interrupt, it must be defined on assembler too when using cmb_fault.S */
+/* #define CMB_USING_DEFERRED_REPORT */
+/* trigger the interrupt which calls cm_backtrace_fault_report(), default is PendSV on bare metal, must config on OS */
+/* #define CMB_DEFERRED_REPORT_TRIGGER()  e.g., NVIC_SetPendingIRQ(SWI_IRQn) */
+/* enable thread fault recovery, the faulted thread is suspended or deleted and the other threads keep running, only for
+ * OS platform, it must be defined on assembler too when using cmb_fault.S */
+/* #define CMB_USING_THREAD_FAULT_RECOVERY */
+/* the action for the faulted thread, default is CMB_THREAD_FAULT_SUSPEND */
+/* #define CMB_THREAD_FAULT_ACTION        CMB_THREAD_FAULT_SUSPEND or CMB_THREAD_FAULT_DELETE */
+/* enable stack canary check on context switch, the painted words on stack bottom are checked by the same hooks as
+ * context switch recorder, the overflowed thread is recorded with its call stack immediately, then it's printed by
+ * cm_backtrace_stack_overflow_report() on a thread or by the deferred report interrupt */
+/* #define CMB_USING_STACK_CHECK */
+/* number of the checked canary words, default is 4 */
+/* #define CMB_STACK_CHECK_WORDS          4 */
+/* enable MPU stack guard, a read-only region on the stack bottom of main stack and the running thread (it's moved on
+ * context switch by rt_scheduler_sethook (RT-Thread), traceTASK_SWITCHED_IN (FreeRTOS) or cm_backtrace_task_sw_hook()
+ * on OSTaskSwHook (uC/OS)), so the stack overflow is faulted on the overflowed store. The RT-Thread scheduler hook is
+ * called before the switched out thread context is saved, so the switched out thread is still guarded by one more
+ * MPU region (CMB_MPU_PREV_THREAD_GUARD_REGION, default is 5) until next context switch */
+/* #define CMB_USING_MPU_STACK_GUARD */
+/* size of the guard region, it must be power of 2 and greater than or equal to 32, default is 32. The stack start
+ * address should be aligned to it, otherwise the guard is rounded up into the stack */
+/* #define CMB_MPU_STACK_GUARD_SIZE       32 */
+/* enable stack owner index, the stack address ranges of all threads and main stack are sorted, so the stack owner of
+ * an address is found by binary search. It's maintained by rt_object_attach_sethook/rt_object_detach_sethook
+ * (RT-Thread), traceTASK_CREATE/traceTASK_DELETE (FreeRTOS) or cm_backtrace_task_create_hook()/
+ * cm_backtrace_task_del_hook() on OSTaskCreateHook/OSTaskDelHook (uC/OS) */
+/* #define CMB_USING_STACK_OWNER */
+/* enable all threads backtrace on fault, only for OS platform */
+/* #define CMB_USING_ALL_THREADS_BACKTRACE */
+/* enable stack high-water mark for main stack and all threads, the main stack is painted on cm_backtrace_init */
+/* #define CMB_USING_STACK_HWM */
+/* warn when the stack headroom percent is less than it, default is 10 */
+/* #define CMB_STACK_HWM_WARN_PERCENT     10 */
+/* enable context switch recorder, it's hooked by rt_scheduler_sethook (RT-Thread), traceTASK_SWITCHED_IN (FreeRTOS)
+ * or cm_backtrace_task_sw_hook() on OSTaskSwHook (uC/OS) */
+/* #define CMB_USING_SWITCH_RECORDER */
+/* number of recorded context switches, it must be power of 2, default is 16 */
+/* #define CMB_SWITCH_RECORDER_SIZE       16 */
+/* max thread name length on context switch record, default is 8 */
+/* #define CMB_SWITCH_RECORD_NAME_MAX     8 */
+/* enable interrupt entry recorder, the vector table trampolines are generated by tools/irq_trampoline */
+/* #define CMB_USING_IRQ_RECORDER */
+/* number of recorded interrupt entries, it must be power of 2, default is 32 */
+/* #define CMB_IRQ_RECORDER_SIZE          32 */
+/* enable tick sampler, cm_backtrace_tick_sample() should be called by SysTick handler (or OS tick hook), the last
+ * samples are retained over the reset and printed on cm_backtrace_init */
+/* #define CMB_USING_TICK_SAMPLER */
+/* number of tick samples, it must be power of 2, default is 16 */
+/* #define CMB_TICK_SAMPLER_SIZE          16 */
+/* timestamp for recorder, default is DWT cycle counter (it's 0 on Cortex-M0) */
+/* #define cmb_get_timestamp()            e.g., rt_tick_get() */
+/* enable hang capture, cm_backtrace_hang() should be called by watchdog early warning interrupt (or hardware timer),
+ * it needs CMB_USING_ALL_THREADS_BACKTRACE */
+/* #define CMB_USING_HANG_CAPTURE */
+/* enable sampling profiler, cm_backtrace_profiler_sample() should be called by a periodic timer interrupt */
+/* #define CMB_USING_PROFILER */
+/* number of different sampled call stacks, it must be power of 2, default is 64 */
+/* #define CMB_PROFILER_TABLE_SIZE        64 */
+/* call stack depth of each sample, default is 4 */
+/* #define CMB_PROFILER_DEPTH             4 */
+/* enable IPC contention profiler on RT-Thread, it's hooked by rt_object_trytake_sethook and rt_object_take_sethook,
+ * it needs RT_USING_HOOK */
+/* #define CMB_USING_IPC_PROFILER */
+/* number of different contended call sites, it must be power of 2, default is 32 */
+/* #define CMB_IPC_PROFILER_TABLE_SIZE    32 */
+/* max object and holder name length on IPC contention profiler, default is 8 */
+/* #define CMB_IPC_PROFILER_NAME_MAX      8 */
+/* enable heap allocation site tracker, it's hooked by rt_malloc_sethook and rt_mp_alloc_sethook (RT-Thread), otherwise
+ * cm_backtrace_heap_alloc()/cm_backtrace_heap_free() should be called by traceMALLOC/traceFREE (FreeRTOS) or after
+ * Mem_HeapAlloc/OSMemGet and before OSMemPut (uC/OS) */
+/* #define CMB_USING_HEAP_TRACKER */
+/* number of different allocation sites, it must be power of 2, default is 64 */
+/* #define CMB_HEAP_TRACKER_SITE_NUM      64 */
+/* number of tracked live allocations, it must be power of 2, default is 256 */
+/* #define CMB_HEAP_TRACKER_ALLOC_NUM     256 */
+/* enable incremental heap verifier, cm_backtrace_heap_verify() is hooked by rt_thread_idle_sethook (RT-Thread, it
+ * replaces the application idle hook, which should be set again after cm_backtrace_init() and call
+ * cm_backtrace_heap_verify() by itself), otherwise it should be called by vApplicationIdleHook (FreeRTOS) or
+ * OSTaskIdleHook (uC/OS-II) */
+/* #define CMB_USING_HEAP_VERIFY */
+/* number of verified heap blocks on each idle slice, default is 8 */
+/* #define CMB_HEAP_VERIFY_SLICE_BLOCKS   8 */
+/* enable soft assert, cm_backtrace_soft_assert() only records the call stack on lock-free ring (it can be called on
+ * interrupt), the records are printed by cm_backtrace_soft_assert_drain() on a low priority thread */
+/* #define CMB_USING_SOFT_ASSERT */
+/* number of soft assert records on lock-free ring, it must be power of 2, default is 16 */
+/* #define CMB_SOFT_ASSERT_RING_SIZE      16 */
+/* enable assert site registry, the CMB_SITE_ASSERT sites are identified by index on a dedicated section and counted */
+/* #define CMB_USING_ASSERT_REGISTRY */
+/* max number of the counted assert sites, default is 128 */
+/* #define CMB_ASSERT_SITE_MAX_NUM        128 */
+/* enable fault path phase timing by cmb_get_timestamp(), it must be defined by user on Cortex-M0 */
+/* #define CMB_USING_PHASE_TIMING */
+/* print the phase timing on the end of fault report */
+/* #define CMB_PHASE_TIMING_ON_REPORT */
+/* enable shadow call stack, the call sites are pushed and popped by -finstrument-functions hooks, so the backtrace is
+ * exact, only for GCC, the cm_backtrace.c and OS kernel must be excluded by -finstrument-functions-exclude-file-list,
+ * the benchmark needs cmb_get_timestamp() which must be defined by user on Cortex-M0 */
+/* #define CMB_USING_SHADOW_STACK */
+/* max call depth of each shadow call stack, default is 32 */
+/* #define CMB_SHADOW_STACK_DEPTH         32 */
+/* enable crash signature table, it counts occurrences of each signature on no initialized RAM */
+/* #define CMB_USING_SIG_TABLE */
+/* enable last fault micro-record on backup registers (e.g., RTC backup registers), it is decoded on next boot */
+/* #define CMB_USING_BKP_RECORD */
+/* backup registers start address for micro-record, needs 6 words, must config when CMB_USING_BKP_RECORD is enable */
+/* #define CMB_BKP_REG_BASE               e.g., (RTC_BASE + 0x50) on STM32F4, the backup domain must be writable */
 /* language of print information */
 /* #define CMB_PRINT_LANGUAGE             CMB_PRINT_LANGUAGE_ENGLISH(default) or CMB_PRINT_LANGUAGE_CHINESE */
 #endif /* _CMB_CFG_H_ */
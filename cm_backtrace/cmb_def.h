@@ -31,6 +31,7 @@
 
 #include <cmb_cfg.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdlib.h>
 
 /* library software version number */
@@ -49,6 +50,9 @@
 #define CMB_PRINT_LANGUAGE_ENGLISH     0
 #define CMB_PRINT_LANGUAGE_CHINESE     1
 
+#define CMB_THREAD_FAULT_SUSPEND       0
+#define CMB_THREAD_FAULT_DELETE        1
+
 /* name max length, default size: 32 */
 #ifndef CMB_NAME_MAX
 #define CMB_NAME_MAX                   32
@@ -69,6 +73,12 @@
     #ifndef CMB_CODE_SECTION_NAME
     #define CMB_CODE_SECTION_NAME          ER_IROM1
     #endif
+    /* no initialized variable attribute, the section must be placed on UNINIT region by scatter file */
+    #ifndef CMB_NOINIT
+    #define CMB_NOINIT                     __attribute__((section("CMB_NOINIT"), zero_init))
+    #endif
+    /* assert site descriptor attribute, the CMB_ASSERT_SITE section is placed on ROM region by scatter file */
+    #define CMB_ASSERT_SITE_SECTION        __attribute__((section("CMB_ASSERT_SITE"), used))
 #elif defined(__ICCARM__)
     /* C stack block name, default is 'CSTACK' */
     #ifndef CMB_CSTACK_BLOCK_NAME
@@ -78,6 +88,12 @@
     #ifndef CMB_CODE_SECTION_NAME
     #define CMB_CODE_SECTION_NAME          ".text"
     #endif
+    /* no initialized variable attribute */
+    #ifndef CMB_NOINIT
+    #define CMB_NOINIT                     __no_init
+    #endif
+    /* assert site descriptor attribute, the "CMB_ASSERT_SITE" section is placed on ROM region by linker config file */
+    #define CMB_ASSERT_SITE_SECTION        _Pragma("location=\"CMB_ASSERT_SITE\"") __root
 #elif defined(__GNUC__)
     /* C stack block start address, defined on linker script file, default is _sstack */
     #ifndef CMB_CSTACK_BLOCK_START
@@ -95,6 +111,20 @@
     #ifndef CMB_CODE_SECTION_END
     #define CMB_CODE_SECTION_END           _etext
     #endif
+    /* no initialized variable attribute, the '.noinit' section must be NOLOAD on linker script file */
+    #ifndef CMB_NOINIT
+    #define CMB_NOINIT                     __attribute__((section(".noinit")))
+    #endif
+    /* assert site descriptor attribute, the 'cmb_assert_site' section is placed on flash as orphan section (or by
+     * KEEP(*(cmb_assert_site)) on linker script file) */
+    #define CMB_ASSERT_SITE_SECTION        __attribute__((section("cmb_assert_site"), used))
+    /* assert site section start and end address, default is the linker generated __start_ and __stop_ symbols */
+    #ifndef CMB_ASSERT_SITE_START
+    #define CMB_ASSERT_SITE_START          __start_cmb_assert_site
+    #endif
+    #ifndef CMB_ASSERT_SITE_END
+    #define CMB_ASSERT_SITE_END            __stop_cmb_assert_site
+    #endif
 #else
     #error "not supported compiler"
 #endif
@@ -104,6 +134,233 @@
 #define CMB_CALL_STACK_MAX_DEPTH       16
 #endif
 
+/* call stack depth (from the top) which is covered by the crash signature, default is 4 */
+#ifndef CMB_SIGNATURE_DEPTH
+#define CMB_SIGNATURE_DEPTH            4
+#endif
+
+/* crash signature table size, default is 8 */
+#ifndef CMB_SIG_TABLE_SIZE
+#define CMB_SIG_TABLE_SIZE             8
+#endif
+
+/* call stack depth which is saved for the first instance of each signature, default is 8 */
+#ifndef CMB_SIG_TABLE_DETAIL_DEPTH
+#define CMB_SIG_TABLE_DETAIL_DEPTH     8
+#endif
+
+/* max number of FreeRTOS tasks which stack bounds are cached by trace macros, default is 16 */
+#ifndef CMB_FREERTOS_TASK_MAX_NUM
+#define CMB_FREERTOS_TASK_MAX_NUM      16
+#endif
+
+/* max number of threads which are walked by all threads backtrace, default is 64 */
+#ifndef CMB_THREAD_MAX_NUM
+#define CMB_THREAD_MAX_NUM             64
+#endif
+
+/* max words which are scanned on each thread stack by all threads backtrace, default is 256 */
+#ifndef CMB_THREAD_STACK_SCAN_MAX_WORDS
+#define CMB_THREAD_STACK_SCAN_MAX_WORDS 256
+#endif
+
+/* number of recorded context switches, it must be power of 2, default is 16 */
+#ifndef CMB_SWITCH_RECORDER_SIZE
+#define CMB_SWITCH_RECORDER_SIZE       16
+#endif
+
+/* max thread name length on context switch record, default is 8 */
+#ifndef CMB_SWITCH_RECORD_NAME_MAX
+#define CMB_SWITCH_RECORD_NAME_MAX     8
+#endif
+
+/* max number of threads on hang record */
+#ifndef CMB_HANG_THREAD_MAX_NUM
+#define CMB_HANG_THREAD_MAX_NUM        16
+#endif
+
+/* call stack depth of each thread on hang record */
+#ifndef CMB_HANG_CALL_STACK_DEPTH
+#define CMB_HANG_CALL_STACK_DEPTH      8
+#endif
+
+/* max number of the owned or waited IPC objects on hang record (only for RT-Thread) */
+#ifndef CMB_HANG_IPC_MAX_NUM
+#define CMB_HANG_IPC_MAX_NUM           16
+#endif
+
+/* number of different sampled call stacks on profiler, it must be power of 2 */
+#ifndef CMB_PROFILER_TABLE_SIZE
+#define CMB_PROFILER_TABLE_SIZE        64
+#endif
+
+/* call stack depth of each profiler sample */
+#ifndef CMB_PROFILER_DEPTH
+#define CMB_PROFILER_DEPTH             4
+#endif
+
+/* number of different contended call sites on IPC contention profiler, it must be power of 2 */
+#ifndef CMB_IPC_PROFILER_TABLE_SIZE
+#define CMB_IPC_PROFILER_TABLE_SIZE    32
+#endif
+
+/* waiter call stack depth of each contended call site */
+#ifndef CMB_IPC_PROFILER_DEPTH
+#define CMB_IPC_PROFILER_DEPTH         4
+#endif
+
+/* max number of the threads which are blocked on IPC at the same time for IPC contention profiler */
+#ifndef CMB_IPC_PROFILER_WAITER_NUM
+#define CMB_IPC_PROFILER_WAITER_NUM    8
+#endif
+
+/* max object and holder name length on IPC contention profiler, default is 8 */
+#ifndef CMB_IPC_PROFILER_NAME_MAX
+#define CMB_IPC_PROFILER_NAME_MAX      8
+#endif
+
+/* number of different allocation sites on heap tracker, it must be power of 2 */
+#ifndef CMB_HEAP_TRACKER_SITE_NUM
+#define CMB_HEAP_TRACKER_SITE_NUM      64
+#endif
+
+/* number of tracked live allocations on heap tracker, it must be power of 2 */
+#ifndef CMB_HEAP_TRACKER_ALLOC_NUM
+#define CMB_HEAP_TRACKER_ALLOC_NUM     256
+#endif
+
+/* caller call stack depth of each allocation site */
+#ifndef CMB_HEAP_TRACKER_DEPTH
+#define CMB_HEAP_TRACKER_DEPTH         3
+#endif
+
+/* number of verified heap blocks on each idle slice of heap verifier */
+#ifndef CMB_HEAP_VERIFY_SLICE_BLOCKS
+#define CMB_HEAP_VERIFY_SLICE_BLOCKS   8
+#endif
+
+/* max number of the registered heap regions on heap verifier */
+#ifndef CMB_HEAP_VERIFY_REGION_NUM
+#define CMB_HEAP_VERIFY_REGION_NUM     4
+#endif
+
+/* number of soft assert records on lock-free ring, it must be power of 2 */
+#ifndef CMB_SOFT_ASSERT_RING_SIZE
+#define CMB_SOFT_ASSERT_RING_SIZE      16
+#endif
+
+/* call stack depth of each soft assert record */
+#ifndef CMB_SOFT_ASSERT_DEPTH
+#define CMB_SOFT_ASSERT_DEPTH          4
+#endif
+
+/* number of rate limited soft assert sites */
+#ifndef CMB_SOFT_ASSERT_SITE_NUM
+#define CMB_SOFT_ASSERT_SITE_NUM       16
+#endif
+
+/* max number of the counted assert sites on assert registry, the sites beyond it are not counted */
+#ifndef CMB_ASSERT_SITE_MAX_NUM
+#define CMB_ASSERT_SITE_MAX_NUM        128
+#endif
+
+/* max call depth which is saved on each shadow call stack */
+#ifndef CMB_SHADOW_STACK_DEPTH
+#define CMB_SHADOW_STACK_DEPTH         32
+#endif
+
+/* index of the thread local storage pointer which saves the shadow call stack on FreeRTOS */
+#ifndef CMB_SHADOW_STACK_TLS_INDEX
+#define CMB_SHADOW_STACK_TLS_INDEX     0
+#endif
+
+/* the action for the faulted thread on thread fault recovery */
+#ifndef CMB_THREAD_FAULT_ACTION
+#define CMB_THREAD_FAULT_ACTION        CMB_THREAD_FAULT_SUSPEND
+#endif
+
+/* number of recorded interrupt entries, it must be power of 2, default is 32 */
+#ifndef CMB_IRQ_RECORDER_SIZE
+#define CMB_IRQ_RECORDER_SIZE          32
+#endif
+
+/* number of tick samples on retained ring, it must be power of 2, default is 16 */
+#ifndef CMB_TICK_SAMPLER_SIZE
+#define CMB_TICK_SAMPLER_SIZE          16
+#endif
+
+/* number of the canary words on stack bottom which are checked on context switch, default is 4 */
+#ifndef CMB_STACK_CHECK_WORDS
+#define CMB_STACK_CHECK_WORDS          4
+#endif
+
+/* size of the read-only guard region on stack bottom, it must be power of 2 and greater than or equal to 32 */
+#ifndef CMB_MPU_STACK_GUARD_SIZE
+#define CMB_MPU_STACK_GUARD_SIZE       32
+#endif
+
+/* MPU region number of the main stack guard */
+#ifndef CMB_MPU_MAIN_GUARD_REGION
+#define CMB_MPU_MAIN_GUARD_REGION      6
+#endif
+
+/* MPU region number of the thread stack guard, it's moved to the switched in thread on each context switch */
+#ifndef CMB_MPU_THREAD_GUARD_REGION
+#define CMB_MPU_THREAD_GUARD_REGION    7
+#endif
+
+/* MPU region number of the switched out thread stack guard on RT-Thread, the scheduler hook is called before the
+ * context of switched out thread is saved, so it's still guarded by this region until next context switch */
+#ifndef CMB_MPU_PREV_THREAD_GUARD_REGION
+#define CMB_MPU_PREV_THREAD_GUARD_REGION 5
+#endif
+
+/* words of the linear probe under the paint boundary which is found by binary search, default is 8 */
+#ifndef CMB_STACK_HWM_PROBE_WORDS
+#define CMB_STACK_HWM_PROBE_WORDS      8
+#endif
+
+/* warn when the stack headroom percent is less than it, default is 10 */
+#ifndef CMB_STACK_HWM_WARN_PERCENT
+#define CMB_STACK_HWM_WARN_PERCENT     10
+#endif
+
+/* configurable fault handlers priority register value, it has no default, the priority 0 (highest configurable
+ * priority) would leave no interrupt above the fault handlers */
+#if defined(CMB_USING_CONFIGURABLE_FAULT) && !defined(CMB_CONFIGURABLE_FAULT_PRIORITY)
+    #error "CMB_CONFIGURABLE_FAULT_PRIORITY must config in 'cmb_cfg.h' when CMB_USING_CONFIGURABLE_FAULT is enable"
+#endif
+
+/* system handler priority register 1 (MemManage, BusFault and UsageFault) */
+#ifndef CMB_SYSHND_PRI1
+#define CMB_SYSHND_PRI1                (*(volatile unsigned int*)  (0xE000ED18u))
+#endif
+
+/* system handler priority register 3 (PendSV and SysTick) */
+#ifndef CMB_SYSHND_PRI3
+#define CMB_SYSHND_PRI3                (*(volatile unsigned int*)  (0xE000ED20u))
+#endif
+
+/* interrupt control and state register */
+#ifndef CMB_NVIC_ICSR
+#define CMB_NVIC_ICSR                  (*(volatile unsigned int*)  (0xE000ED04u))
+#endif
+
+/* debug exception and monitor control register */
+#ifndef CMB_DEMCR
+#define CMB_DEMCR                      (*(volatile unsigned int*)  (0xE000EDFCu))
+#endif
+
+/* DWT control register */
+#ifndef CMB_DWT_CTRL
+#define CMB_DWT_CTRL                   (*(volatile unsigned int*)  (0xE0001000u))
+#endif
+
+/* DWT cycle count register */
+#ifndef CMB_DWT_CYCCNT
+#define CMB_DWT_CYCCNT                 (*(volatile unsigned int*)  (0xE0001004u))
+#endif
+
 /* system handler control and state register */
 #ifndef CMB_SYSHND_CTRL
 #define CMB_SYSHND_CTRL                (*(volatile unsigned int*)  (0xE000ED24u))
@@ -149,6 +406,18 @@
 #define CMB_NVIC_AFSR                  (*(volatile unsigned short*)(0xE000ED3Cu))
 #endif
 
+#ifndef CMB_MPU_CTRL
+#define CMB_MPU_CTRL                   (*(volatile unsigned int*)  (0xE000ED94u))
+#endif
+
+#ifndef CMB_MPU_RBAR
+#define CMB_MPU_RBAR                   (*(volatile unsigned int*)  (0xE000ED9Cu))
+#endif
+
+#ifndef CMB_MPU_RASR
+#define CMB_MPU_RASR                   (*(volatile unsigned int*)  (0xE000EDA0u))
+#endif
+
 /**
  * Cortex-M fault registers
  */
@@ -262,13 +531,272 @@ struct cmb_hard_fault_regs{
   unsigned int afsr;                     // Auxiliary Fault Status Register (0xE000ED3C), Vendor controlled (optional)
 };
 
+/**
+ * thread information for all threads backtrace
+ */
+struct cmb_thread_info {
+    const char *name;
+    uint32_t id;                       /* thread control block address */
+    uint32_t sp;                       /* saved stack pointer on last switched out, it is stale for running thread */
+    uint32_t stack_start_addr;
+    size_t stack_size;
+};
+
+/**
+ * context switch record, the thread is the thread control block address
+ */
+struct cmb_switch_record {
+    uint32_t timestamp;
+    uint32_t from;
+    uint32_t to;
+    uint32_t pc;                       /* the switched out thread PC, 0: unknown */
+    char from_name[CMB_SWITCH_RECORD_NAME_MAX]; /* it's not terminated when the name is too long */
+    char to_name[CMB_SWITCH_RECORD_NAME_MAX];
+};
+
+/**
+ * context switch recorder on no initialized RAM
+ */
+struct cmb_switch_recorder {
+    uint32_t magic;
+    uint32_t index;                    /* the total number of records, the next record is index % size */
+    struct cmb_switch_record records[CMB_SWITCH_RECORDER_SIZE];
+};
+
+/**
+ * interrupt entry record
+ */
+struct cmb_irq_record {
+    uint32_t timestamp;
+    uint32_t exception;                /* IPSR exception number, the IRQ number is exception - 16 */
+    uint32_t pc;                       /* the preempted PC */
+};
+
+/**
+ * interrupt entry recorder on no initialized RAM
+ */
+struct cmb_irq_recorder {
+    uint32_t magic;
+    uint32_t index;                    /* the total number of records, the next record is index % size */
+    struct cmb_irq_record records[CMB_IRQ_RECORDER_SIZE];
+};
+
+/**
+ * tick sample of the interrupted context
+ */
+struct cmb_tick_sample {
+    uint32_t pc;
+    uint32_t lr;
+    uint32_t thread;                   /* the interrupted thread ID, 0: interrupt or bare metal */
+};
+
+/**
+ * tick sampler on no initialized RAM
+ */
+struct cmb_tick_sampler {
+    uint32_t magic;
+    uint32_t index;                    /* the total number of samples, the next sample is index % size */
+    struct cmb_tick_sample samples[CMB_TICK_SAMPLER_SIZE];
+};
+
+/**
+ * profiler record, the samples which have same call stack are counted on one record
+ */
+struct cmb_profiler_record {
+    uint32_t hash;                     /* call stack hash, 0: empty record */
+    uint32_t count;
+    uint32_t depth;
+    uint32_t call_stack[CMB_PROFILER_DEPTH];
+};
+
+/**
+ * contended call site on IPC contention profiler, the blocking takes which have same waiter call stack and object are
+ * counted on one record
+ */
+struct cmb_ipc_contention {
+    uint32_t hash;                     /* waiter call stack and object hash, 0: empty record */
+    uint32_t object;                   /* IPC object address */
+    uint32_t holder;                   /* the last holder thread ID (only for mutex), 0: no holder */
+    char object_name[CMB_IPC_PROFILER_NAME_MAX]; /* it's not terminated when the name is too long */
+    char holder_name[CMB_IPC_PROFILER_NAME_MAX]; /* "-": no holder */
+    uint32_t count;                    /* number of blocking takes */
+    uint32_t total_wait;               /* total wait duration by cmb_get_timestamp() */
+    uint32_t max_wait;                 /* max wait duration by cmb_get_timestamp() */
+    uint32_t depth;
+    uint32_t call_stack[CMB_IPC_PROFILER_DEPTH];
+};
+
+/**
+ * heap allocation site, the live allocations which have same caller call stack are counted on one site
+ */
+struct cmb_heap_site {
+    uint32_t hash;                     /* caller call stack hash, 0: empty site */
+    uint32_t live_bytes;
+    uint32_t live_num;                 /* number of live allocations */
+    uint32_t alloc_num;                /* total number of allocations */
+    uint32_t depth;
+    uint32_t call_stack[CMB_HEAP_TRACKER_DEPTH];
+};
+
+/**
+ * thread call stack on hang record
+ */
+struct cmb_hang_thread {
+    uint32_t id;
+    uint32_t depth;
+    uint32_t call_stack[CMB_HANG_CALL_STACK_DEPTH];
+};
+
+/**
+ * the owned or waited IPC object on hang record
+ */
+struct cmb_hang_ipc {
+    uint32_t object;                   /* IPC object address */
+    uint32_t type;                     /* OS object type, e.g., RT_Object_Class_Mutex */
+    uint32_t owner;                    /* owner thread ID (only for mutex), 0: no owner */
+    uint32_t value;                    /* hold count of mutex or value of semaphore */
+    uint32_t waiter_num;               /* number of the suspended threads */
+    uint32_t waiter;                   /* the first suspended thread ID, 0: no waiter */
+};
+
+/**
+ * hang record on no initialized RAM, it's saved before the watchdog reset
+ */
+struct cmb_hang_record {
+    uint32_t magic;
+    uint32_t signature;
+    uint32_t thread;                   /* the thread ID which is interrupted by hang capture, 0: interrupt */
+    uint32_t thread_num;
+    struct cmb_hang_thread threads[CMB_HANG_THREAD_MAX_NUM];
+    uint32_t ipc_num;
+    struct cmb_hang_ipc ipcs[CMB_HANG_IPC_MAX_NUM];
+};
+
+/* the timed phases of fault path */
+#define CMB_PHASE_CAPTURE              0   /* capture the fault registers */
+#define CMB_PHASE_STACK_SCAN           1   /* scan the fault stack for call stack and calculate the signature */
+#define CMB_PHASE_DIAGNOSIS            2   /* print the fault diagnosis */
+#define CMB_PHASE_DUMP_STACK           3   /* print the stack data */
+#define CMB_PHASE_REPORT               4   /* print the whole fault report */
+#define CMB_PHASE_NUM                  5
+
+/**
+ * elapsed time of one phase, the unit is same as cmb_get_timestamp()
+ */
+struct cmb_phase_time {
+    uint32_t last;
+    uint32_t min;
+    uint32_t max;
+    uint32_t count;                    /* timed count, the min is invalid when it is 0 */
+};
+
+/**
+ * fault path phase timing
+ */
+struct cmb_phase_timing {
+    struct cmb_phase_time phases[CMB_PHASE_NUM];
+};
+
+/**
+ * stack overflow record which is detected on context switch
+ */
+struct cmb_stack_overflow_record {
+    uint32_t thread;                   /* thread control block address */
+    uint32_t sp;                       /* saved stack pointer of the thread */
+    uint32_t stack_start_addr;
+    uint32_t stack_size;
+    uint32_t hwm;                      /* high-water mark, it's greater than or equal to stack size on overflow */
+    uint32_t pc;                       /* the saved PC of the thread */
+    uint32_t lr;                       /* the saved LR of the thread */
+    uint32_t signature;
+    uint32_t depth;
+    uint32_t call_stack[CMB_CALL_STACK_MAX_DEPTH];
+    char name[CMB_NAME_MAX];           /* thread name, it's not terminated when the name is too long */
+};
+
+/**
+ * stack owner on the stack owner index, it's the address range of a thread stack or the main stack
+ */
+struct cmb_stack_owner {
+    uint32_t start_addr;
+    uint32_t end_addr;
+    uint32_t thread;                   /* thread ID, 0: main stack */
+};
+
+/**
+ * shadow call stack of one thread (or main stack), it's pushed and popped by -finstrument-functions hooks
+ */
+struct cmb_shadow_stack {
+    volatile uint32_t depth;           /* current call depth, the calls beyond CMB_SHADOW_STACK_DEPTH are not saved */
+    uint32_t call_sites[CMB_SHADOW_STACK_DEPTH]; /* the call instruction address of each call, outermost is first */
+};
+
+/**
+ * last fault micro-record which is saved on backup registers
+ */
+struct cmb_bkp_record {
+    uint32_t cause;                      /* fault type, it is the cause bits of fault status registers */
+    uint32_t pc;                         /* program counter */
+    uint32_t lr;                         /* link register */
+    uint32_t thread;                     /* faulted thread control block address, 0: fault on interrupt or bare metal */
+    uint32_t signature;                  /* crash signature */
+};
+
+/**
+ * crash signature record, only the first instance of each signature keeps the call stack
+ */
+struct cmb_sig_record {
+    uint32_t signature;                  /* crash signature */
+    uint32_t type;                       /* fault type, it is the cause bits of fault status registers */
+    uint32_t count;                      /* occurrence count */
+    uint32_t depth;                      /* saved call stack depth */
+    uint32_t call_stack[CMB_SIG_TABLE_DETAIL_DEPTH]; /* call stack of the first instance */
+};
+
+/**
+ * crash signature table, it is retained on the no initialized RAM
+ */
+struct cmb_sig_table {
+    uint32_t magic;                      /* table magic word, the table is invalid when it is not SIG_TABLE_MAGIC */
+    uint32_t num;                        /* used records number */
+    uint32_t dropped;                    /* occurrence count of the new signatures which dropped by table is full */
+    struct cmb_sig_record records[CMB_SIG_TABLE_SIZE];
+};
+
+/**
+ * assert site descriptor, it is placed on the assert site section, so the site is identified by its index on section
+ */
+struct cmb_assert_site {
+    uint16_t file_id;                    /* file ID which is defined by CMB_ASSERT_FILE_ID on source file */
+    uint16_t line;                       /* line number */
+};
+
+/* the file ID of library assert sites */
+#define CMB_ASSERT_LIB_FILE_ID         0xFFFF
+
+/* define the assert site descriptor on assert site section */
+#define CMB_ASSERT_SITE_DEFINE(NAME, FILE_ID)                                  \
+    CMB_ASSERT_SITE_SECTION static const struct cmb_assert_site NAME = { (FILE_ID), (uint16_t) __LINE__ }
+
 /* assert for developer. */
+#ifdef CMB_USING_ASSERT_REGISTRY
+/* the expression and function name strings are not saved on flash, the site is printed by index */
+#define CMB_ASSERT(EXPR)                                                       \
+if (!(EXPR))                                                                   \
+{                                                                              \
+    CMB_ASSERT_SITE_DEFINE(_cmb_assert_site, CMB_ASSERT_LIB_FILE_ID);          \
+    cmb_println("Assert site %u has assert failed.",                           \
+            (unsigned int) cm_backtrace_assert_site_hit(&_cmb_assert_site));   \
+    while (1);                                                                 \
+}
+#else
 #define CMB_ASSERT(EXPR)                                                       \
 if (!(EXPR))                                                                   \
 {                                                                              \
     cmb_println("(%s) has assert failed at %s.", #EXPR, __FUNCTION__);         \
     while (1);                                                                 \
 }
+#endif
 
 /* ELF(Executable and Linking Format) file extension name for each compiler */
 #if defined(__CC_ARM)
@@ -285,10 +813,23 @@ if (!(EXPR))                                                                   \
     #error "cmb_println isn't defined in 'cmb_cfg.h'"
 #endif
 
+/* feed the watchdog between the report chunks, it is optional */
+#ifndef cmb_wdt_feed
+    #define cmb_wdt_feed()
+#endif
+
 #ifndef CMB_CPU_PLATFORM_TYPE
     #error "CMB_CPU_PLATFORM_TYPE isn't defined in 'cmb_cfg.h'"
 #endif
 
+#if defined(CMB_USING_CONFIGURABLE_FAULT) && (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M0)
+    #error "the Cortex-M0 is not support CMB_USING_CONFIGURABLE_FAULT"
+#endif
+
+#if defined(CMB_USING_BKP_RECORD) && !defined(CMB_BKP_REG_BASE)
+    #error "CMB_BKP_REG_BASE isn't defined in 'cmb_cfg.h'"
+#endif
+
 #if (defined(CMB_USING_BARE_METAL_PLATFORM) && defined(CMB_USING_OS_PLATFORM))
     #error "CMB_USING_BARE_METAL_PLATFORM and CMB_USING_OS_PLATFORM only one of them can be used"
 #elif defined(CMB_USING_OS_PLATFORM)
@@ -302,16 +843,219 @@ if (!(EXPR))                                                                   \
     #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
         #include <os.h>
     #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
-        #include <FreeRTOS.h>  
-        extern uint32_t *vTaskStackAddr(void);/* need to modify the FreeRTOS/tasks source code */
-        extern uint32_t vTaskStackSize(void);
-        extern char * vTaskName(void);
+        #include <FreeRTOS.h>
+        #include <task.h>
+        /* the task stack bounds are got by vTaskGetInfo and cached on task number by trace macros */
+        #if (configUSE_TRACE_FACILITY != 1)
+            #error "configUSE_TRACE_FACILITY must be 1 in 'FreeRTOSConfig.h' for CmBacktrace"
+        #endif
     #else
         #error "not supported OS type"
     #endif /* (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) */
 #endif /* (defined(CMB_USING_BARE_METAL_PLATFORM) && defined(CMB_USING_OS_PLATFORM)) */
 
-/* include or export for supported cmb_get_msp, cmb_get_psp and cmb_get_sp function */
+#if defined(CMB_USING_ALL_THREADS_BACKTRACE) && !defined(CMB_USING_OS_PLATFORM)
+    #error "CMB_USING_ALL_THREADS_BACKTRACE only can be used on OS platform"
+#endif
+
+#if defined(CMB_USING_HANG_CAPTURE) && !defined(CMB_USING_ALL_THREADS_BACKTRACE)
+    #error "CMB_USING_HANG_CAPTURE needs CMB_USING_ALL_THREADS_BACKTRACE"
+#endif
+
+#ifdef CMB_USING_SWITCH_RECORDER
+    #if !defined(CMB_USING_OS_PLATFORM)
+        #error "CMB_USING_SWITCH_RECORDER only can be used on OS platform"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && !defined(RT_USING_HOOK)
+        #error "CMB_USING_SWITCH_RECORDER needs RT_USING_HOOK on RT-Thread"
+    #endif
+    #if (CMB_SWITCH_RECORDER_SIZE & (CMB_SWITCH_RECORDER_SIZE - 1)) != 0
+        #error "CMB_SWITCH_RECORDER_SIZE must be power of 2"
+    #endif
+#endif
+
+#ifdef CMB_USING_PROFILER
+    #if (CMB_PROFILER_TABLE_SIZE & (CMB_PROFILER_TABLE_SIZE - 1)) != 0
+        #error "CMB_PROFILER_TABLE_SIZE must be power of 2"
+    #endif
+    #if CMB_PROFILER_DEPTH > CMB_CALL_STACK_MAX_DEPTH
+        #error "CMB_PROFILER_DEPTH must be less than or equal to CMB_CALL_STACK_MAX_DEPTH"
+    #endif
+#endif
+
+#ifdef CMB_USING_IPC_PROFILER
+    #if !defined(CMB_USING_OS_PLATFORM) || (CMB_OS_PLATFORM_TYPE != CMB_OS_PLATFORM_RTT)
+        #error "CMB_USING_IPC_PROFILER only can be used on RT-Thread"
+    #elif !defined(RT_USING_HOOK)
+        #error "CMB_USING_IPC_PROFILER needs RT_USING_HOOK"
+    #endif
+    #if (CMB_IPC_PROFILER_TABLE_SIZE & (CMB_IPC_PROFILER_TABLE_SIZE - 1)) != 0
+        #error "CMB_IPC_PROFILER_TABLE_SIZE must be power of 2"
+    #endif
+    #if CMB_IPC_PROFILER_DEPTH > CMB_CALL_STACK_MAX_DEPTH
+        #error "CMB_IPC_PROFILER_DEPTH must be less than or equal to CMB_CALL_STACK_MAX_DEPTH"
+    #endif
+#endif
+
+#ifdef CMB_USING_HEAP_TRACKER
+    #if defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && !defined(RT_USING_HOOK)
+        #error "CMB_USING_HEAP_TRACKER needs RT_USING_HOOK on RT-Thread"
+    #endif
+    #if (CMB_HEAP_TRACKER_SITE_NUM & (CMB_HEAP_TRACKER_SITE_NUM - 1)) != 0
+        #error "CMB_HEAP_TRACKER_SITE_NUM must be power of 2"
+    #endif
+    #if (CMB_HEAP_TRACKER_ALLOC_NUM & (CMB_HEAP_TRACKER_ALLOC_NUM - 1)) != 0
+        #error "CMB_HEAP_TRACKER_ALLOC_NUM must be power of 2"
+    #endif
+    #if CMB_HEAP_TRACKER_DEPTH > CMB_CALL_STACK_MAX_DEPTH
+        #error "CMB_HEAP_TRACKER_DEPTH must be less than or equal to CMB_CALL_STACK_MAX_DEPTH"
+    #endif
+#endif
+
+#ifdef CMB_USING_HEAP_VERIFY
+    #if !defined(CMB_USING_OS_PLATFORM)
+        #error "CMB_USING_HEAP_VERIFY only can be used on OS platform"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII)
+        #error "CMB_USING_HEAP_VERIFY is not supported on uC/OS-III"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && !defined(RT_USING_HOOK)
+        #error "CMB_USING_HEAP_VERIFY needs RT_USING_HOOK on RT-Thread"
+    #endif
+    #if CMB_HEAP_VERIFY_SLICE_BLOCKS < 2
+        #error "CMB_HEAP_VERIFY_SLICE_BLOCKS must be greater than 1, the last verified block is verified again on slice"
+    #endif
+#endif
+
+#ifdef CMB_USING_SOFT_ASSERT
+    #if (CMB_SOFT_ASSERT_RING_SIZE & (CMB_SOFT_ASSERT_RING_SIZE - 1)) != 0
+        #error "CMB_SOFT_ASSERT_RING_SIZE must be power of 2"
+    #endif
+    #if CMB_SOFT_ASSERT_DEPTH > CMB_CALL_STACK_MAX_DEPTH
+        #error "CMB_SOFT_ASSERT_DEPTH must be less than or equal to CMB_CALL_STACK_MAX_DEPTH"
+    #endif
+#endif
+
+#ifdef CMB_USING_THREAD_FAULT_RECOVERY
+    #if !defined(CMB_USING_OS_PLATFORM)
+        #error "CMB_USING_THREAD_FAULT_RECOVERY only can be used on OS platform"
+    #elif (CMB_THREAD_FAULT_ACTION != CMB_THREAD_FAULT_SUSPEND) && (CMB_THREAD_FAULT_ACTION != CMB_THREAD_FAULT_DELETE)
+        #error "CMB_THREAD_FAULT_ACTION defined error in 'cmb_cfg.h'"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS) && (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_SUSPEND) \
+            && (INCLUDE_vTaskSuspend != 1)
+        #error "CMB_THREAD_FAULT_SUSPEND needs INCLUDE_vTaskSuspend on FreeRTOS"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS) && (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_DELETE) \
+            && (INCLUDE_vTaskDelete != 1)
+        #error "CMB_THREAD_FAULT_DELETE needs INCLUDE_vTaskDelete on FreeRTOS"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII) && (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_SUSPEND) \
+            && !(OS_TASK_SUSPEND_EN > 0u)
+        #error "CMB_THREAD_FAULT_SUSPEND needs OS_TASK_SUSPEND_EN on uC/OS-II"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII) && (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_DELETE) \
+            && !(OS_TASK_DEL_EN > 0u)
+        #error "CMB_THREAD_FAULT_DELETE needs OS_TASK_DEL_EN on uC/OS-II"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII) && (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_SUSPEND) \
+            && !(OS_CFG_TASK_SUSPEND_EN > 0u)
+        #error "CMB_THREAD_FAULT_SUSPEND needs OS_CFG_TASK_SUSPEND_EN on uC/OS-III"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSIII) && (CMB_THREAD_FAULT_ACTION == CMB_THREAD_FAULT_DELETE) \
+            && !(OS_CFG_TASK_DEL_EN > 0u)
+        #error "CMB_THREAD_FAULT_DELETE needs OS_CFG_TASK_DEL_EN on uC/OS-III"
+    #endif
+#endif
+
+#ifdef CMB_USING_SHADOW_STACK
+    #if !defined(__GNUC__) || defined(__CC_ARM)
+        #error "CMB_USING_SHADOW_STACK needs -finstrument-functions, it only can be used on GCC (or armclang)"
+    #elif defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS) \
+            && !(configNUM_THREAD_LOCAL_STORAGE_POINTERS > CMB_SHADOW_STACK_TLS_INDEX)
+        #error "CMB_USING_SHADOW_STACK needs configNUM_THREAD_LOCAL_STORAGE_POINTERS > CMB_SHADOW_STACK_TLS_INDEX on FreeRTOS"
+    #elif defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_UCOSII) \
+            && !(OS_TASK_CREATE_EXT_EN > 0u)
+        #error "CMB_USING_SHADOW_STACK needs OS_TASK_CREATE_EXT_EN on uC/OS-II"
+    #endif
+#endif
+
+#if defined(CMB_USING_IRQ_RECORDER) && (CMB_IRQ_RECORDER_SIZE & (CMB_IRQ_RECORDER_SIZE - 1)) != 0
+    #error "CMB_IRQ_RECORDER_SIZE must be power of 2"
+#endif
+
+#ifdef CMB_USING_STACK_CHECK
+    #if !defined(CMB_USING_OS_PLATFORM)
+        #error "CMB_USING_STACK_CHECK only can be used on OS platform"
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && !defined(RT_USING_HOOK)
+        #error "CMB_USING_STACK_CHECK needs RT_USING_HOOK on RT-Thread"
+    #elif CMB_STACK_CHECK_WORDS < 1
+        #error "CMB_STACK_CHECK_WORDS must be greater than 0"
+    #endif
+#endif
+
+#if defined(CMB_USING_STACK_OWNER) && !defined(CMB_USING_OS_PLATFORM)
+    #error "CMB_USING_STACK_OWNER only can be used on OS platform"
+#elif defined(CMB_USING_STACK_OWNER) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && !defined(RT_USING_HOOK)
+    #error "CMB_USING_STACK_OWNER needs RT_USING_HOOK on RT-Thread"
+#endif
+
+#ifdef CMB_USING_MPU_STACK_GUARD
+    #if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M0)
+        #error "the Cortex-M0 is not support CMB_USING_MPU_STACK_GUARD"
+    #elif defined(CMB_USING_OS_PLATFORM) && (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT) && !defined(RT_USING_HOOK)
+        #error "CMB_USING_MPU_STACK_GUARD needs RT_USING_HOOK on RT-Thread"
+    #elif (CMB_MPU_STACK_GUARD_SIZE < 32) || (CMB_MPU_STACK_GUARD_SIZE & (CMB_MPU_STACK_GUARD_SIZE - 1)) != 0
+        #error "CMB_MPU_STACK_GUARD_SIZE must be power of 2 and greater than or equal to 32"
+    #endif
+#endif
+
+#if defined(CMB_USING_TICK_SAMPLER) && (CMB_TICK_SAMPLER_SIZE & (CMB_TICK_SAMPLER_SIZE - 1)) != 0
+    #error "CMB_TICK_SAMPLER_SIZE must be power of 2"
+#endif
+
+/* the Cortex-M0 has no DWT cycle counter, the timestamp is 0 when it isn't defined by user */
+#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M0) && !defined(cmb_get_timestamp)
+    #if defined(CMB_USING_PHASE_TIMING)
+        #error "CMB_USING_PHASE_TIMING needs cmb_get_timestamp() which is defined by user on Cortex-M0"
+    #elif defined(CMB_USING_SHADOW_STACK)
+        #error "CMB_USING_SHADOW_STACK needs cmb_get_timestamp() which is defined by user on Cortex-M0 for benchmark"
+    #endif
+#endif
+
+/* timestamp for recorder, the DWT cycle counter is enabled on cm_backtrace_init */
+#ifndef cmb_get_timestamp
+    #if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M0)
+        #define cmb_get_timestamp()    0
+    #else
+        #define cmb_get_timestamp()    CMB_DWT_CYCCNT
+    #endif
+#endif
+
+/* the threads walking is used by all threads backtrace and stack high-water mark */
+#if defined(CMB_USING_OS_PLATFORM) && (defined(CMB_USING_ALL_THREADS_BACKTRACE) || defined(CMB_USING_STACK_HWM) \
+        || defined(CMB_USING_STACK_OWNER))
+    #define CMB_USING_THREAD_WALK
+#endif
+
+/* the paint word of unused stack which is filled by OS on thread created, the main stack is painted by library */
+#ifndef CMB_STACK_PAINT_WORD
+    #if !defined(CMB_USING_OS_PLATFORM)
+        #define CMB_STACK_PAINT_WORD   0xCBCBCBCB
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_RTT)
+        /* '#' which is filled by _rt_thread_init */
+        #define CMB_STACK_PAINT_WORD   0x23232323
+    #elif (CMB_OS_PLATFORM_TYPE == CMB_OS_PLATFORM_FREERTOS)
+        /* tskSTACK_FILL_BYTE */
+        #define CMB_STACK_PAINT_WORD   0xA5A5A5A5
+    #else
+        /* the task must be created with OS_TASK_OPT_STK_CLR (uC/OS-II) or OS_OPT_TASK_STK_CLR (uC/OS-III) */
+        #define CMB_STACK_PAINT_WORD   0x00000000
+    #endif
+#endif
+
+#if defined(CMB_USING_DEFERRED_REPORT) && !defined(CMB_DEFERRED_REPORT_TRIGGER)
+    #ifdef CMB_USING_OS_PLATFORM
+        #error "CMB_DEFERRED_REPORT_TRIGGER isn't defined in 'cmb_cfg.h', the PendSV is used by OS"
+    #endif
+    /* pend the PendSV, it will be set to lowest priority on cm_backtrace_init */
+    #define CMB_DEFERRED_REPORT_TRIGGER()  (CMB_NVIC_ICSR = (1UL << 28))
+    #define CMB_DEFERRED_REPORT_USING_PENDSV
+#endif
+
+/* include or export for supported cmb_get_msp, cmb_get_psp, cmb_get_sp, cmb_get_primask, cmb_get_basepri, cmb_irq_lock
+ * and cmb_irq_unlock function, the BASEPRI is always 0 on Cortex-M0 */
 #if defined(__CC_ARM)
     static __inline __asm uint32_t cmb_get_msp(void) {
         mrs r0, msp
@@ -325,6 +1069,27 @@ if (!(EXPR))                                                                   \
         mov r0, sp
         bx lr
     }
+    static __inline __asm uint32_t cmb_get_primask(void) {
+        mrs r0, primask
+        bx lr
+    }
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+    static __inline __asm uint32_t cmb_get_basepri(void) {
+        mrs r0, basepri
+        bx lr
+    }
+#else
+    #define cmb_get_basepri()          0
+#endif
+    static __inline __asm uint32_t cmb_irq_lock(void) {
+        mrs r0, primask
+        cpsid i
+        bx lr
+    }
+    static __inline __asm void cmb_irq_unlock(uint32_t primask) {
+        msr primask, r0
+        bx lr
+    }
 #elif defined(__ICCARM__)
 /* IAR iccarm specific functions */
 /* Close Raw Asm Code Warning */  
@@ -344,6 +1109,31 @@ if (!(EXPR))                                                                   \
       __asm("mov r0, sp");
       __asm("bx lr");       
     }
+    static uint32_t cmb_get_primask(void)
+    {
+      __asm("mrs r0, primask");
+      __asm("bx lr");
+    }
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+    static uint32_t cmb_get_basepri(void)
+    {
+      __asm("mrs r0, basepri");
+      __asm("bx lr");
+    }
+#else
+    #define cmb_get_basepri()          0
+#endif
+    static uint32_t cmb_irq_lock(void)
+    {
+      __asm("mrs r0, primask");
+      __asm("cpsid i");
+      __asm("bx lr");
+    }
+    static void cmb_irq_unlock(uint32_t primask)
+    {
+      __asm("msr primask, r0");
+      __asm("bx lr");
+    }
 #pragma diag_default=Pe940  
 #elif defined(__GNUC__)
     __attribute__( ( always_inline ) ) static inline uint32_t cmb_get_msp(void) {
@@ -361,8 +1151,97 @@ if (!(EXPR))                                                                   \
         __asm volatile ("MOV %0, sp\n" : "=r" (result) );
         return(result);
     }
+    __attribute__( ( always_inline ) ) static inline uint32_t cmb_get_primask(void) {
+        register uint32_t result;
+        __asm volatile ("MRS %0, primask\n" : "=r" (result) );
+        return(result);
+    }
+#if (CMB_CPU_PLATFORM_TYPE != CMB_CPU_ARM_CORTEX_M0)
+    __attribute__( ( always_inline ) ) static inline uint32_t cmb_get_basepri(void) {
+        register uint32_t result;
+        __asm volatile ("MRS %0, basepri\n" : "=r" (result) );
+        return(result);
+    }
+#else
+    #define cmb_get_basepri()          0
+#endif
+    __attribute__( ( always_inline ) ) static inline uint32_t cmb_irq_lock(void) {
+        register uint32_t result;
+        __asm volatile ("MRS %0, primask\n CPSID i\n" : "=r" (result) : : "memory");
+        return(result);
+    }
+    __attribute__( ( always_inline ) ) static inline void cmb_irq_unlock(uint32_t primask) {
+        __asm volatile ("MSR primask, %0\n" : : "r" (primask) : "memory");
+    }
 #else
     #error "not supported compiler"
 #endif
 
+#ifdef CMB_USING_SOFT_ASSERT
+/* the cmb_atomic_cas (compare and swap a word, return 1 when it is swapped) and cmb_dmb (data memory barrier) function
+ * for lock-free soft assert ring, the Cortex-M0 has no exclusive access, so the interrupts are locked on CAS */
+#if (CMB_CPU_PLATFORM_TYPE == CMB_CPU_ARM_CORTEX_M0)
+    static inline uint32_t cmb_atomic_cas(volatile uint32_t *addr, uint32_t expected, uint32_t desired) {
+        uint32_t primask = cmb_irq_lock(), swapped = 0;
+
+        if (*addr == expected) {
+            *addr = desired;
+            swapped = 1;
+        }
+        cmb_irq_unlock(primask);
+
+        return swapped;
+    }
+#elif defined(__CC_ARM)
+    static __inline uint32_t cmb_atomic_cas(volatile uint32_t *addr, uint32_t expected, uint32_t desired) {
+        do {
+            if (__ldrex(addr) != expected) {
+                __clrex();
+                return 0;
+            }
+        } while (__strex(desired, addr));
+
+        return 1;
+    }
+#elif defined(__ICCARM__)
+    #include <intrinsics.h>
+    static uint32_t cmb_atomic_cas(volatile uint32_t *addr, uint32_t expected, uint32_t desired)
+    {
+      do {
+          if (__LDREX((unsigned long *) addr) != expected) {
+              __CLREX();
+              return 0;
+          }
+      } while (__STREX(desired, (unsigned long *) addr));
+
+      return 1;
+    }
+#elif defined(__GNUC__)
+    __attribute__( ( always_inline ) ) static inline uint32_t cmb_atomic_cas(volatile uint32_t *addr, uint32_t expected,
+            uint32_t desired) {
+        return __atomic_compare_exchange_n(addr, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+#endif
+
+#if defined(__CC_ARM)
+    #define cmb_dmb()                  __dmb(0xF)
+#elif defined(__ICCARM__)
+    #define cmb_dmb()                  __DMB()
+#elif defined(__GNUC__)
+    #define cmb_dmb()                  __asm volatile ("DMB\n" : : : "memory")
+#endif
+#endif /* CMB_USING_SOFT_ASSERT */
+
+#ifdef CMB_USING_MPU_STACK_GUARD
+/* the cmb_dsb_isb (data and instruction synchronization barrier) function, the MPU setting takes effect after it */
+#if defined(__CC_ARM)
+    #define cmb_dsb_isb()              do { __dsb(0xF); __isb(0xF); } while (0)
+#elif defined(__ICCARM__)
+    #include <intrinsics.h>
+    #define cmb_dsb_isb()              do { __DSB(); __ISB(); } while (0)
+#elif defined(__GNUC__)
+    #define cmb_dsb_isb()              __asm volatile ("DSB\n" "ISB\n" : : : "memory")
+#endif
+#endif /* CMB_USING_MPU_STACK_GUARD */
+
 #endif /* _CMB_DEF_H_ */
@@ -172,4 +172,14 @@ standard names. */
 #define vPortSVCHandler SVC_Handler
 #define xPortSysTickHandler SysTick_Handler
 
+/* CmBacktrace caches the task stack bounds by trace macros, so the FreeRTOS source code needn't be modified. */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+    extern void cm_backtrace_freertos_task_create(void *task);
+    extern void cm_backtrace_freertos_task_delete(void *task);
+    extern void cm_backtrace_freertos_task_switched_in(void *task);
+#endif
+#define traceTASK_CREATE(pxNewTCB)       cm_backtrace_freertos_task_create(pxNewTCB)
+#define traceTASK_DELETE(pxTCB)          cm_backtrace_freertos_task_delete(pxTCB)
+#define traceTASK_SWITCHED_IN()          cm_backtrace_freertos_task_switched_in(pxCurrentTCB)
+
 #endif /* FREERTOS_CONFIG_H */
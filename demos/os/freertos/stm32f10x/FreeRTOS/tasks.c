@@ -306,9 +306,7 @@ typedef struct tskTaskControlBlock
 
 	#if ( portSTACK_GROWTH > 0 )
 		StackType_t		*pxEndOfStack;		/*< Points to the end of the stack on architectures where the stack grows up from low memory. */
-	#else
-        UBaseType_t     uxSizeOfStack;      /*< Support For CmBacktrace >*/
-    #endif /* ( portSTACK_GROWTH > 0 )*/
+	#endif /* portSTACK_GROWTH */
 
 	#if ( portCRITICAL_NESTING_IN_TCB == 1 )
 		UBaseType_t		uxCriticalNesting;	/*< Holds the critical section nesting depth for ports that do not maintain their own count in the port layer. */
@@ -810,9 +808,7 @@ UBaseType_t x;
 
 		/* Check the alignment of the calculated top of stack is correct. */
 		configASSERT( ( ( ( portPOINTER_SIZE_TYPE ) pxTopOfStack & ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) == 0UL ) );
-        
-        pxNewTCB->uxSizeOfStack = ulStackDepth;   /*< Support For CmBacktrace >*/
-    }
+	}
 	#else /* portSTACK_GROWTH */
 	{
 		pxTopOfStack = pxNewTCB->pxStack;
@@ -4803,30 +4799,6 @@ const TickType_t xConstTickCount = xTickCount;
 	#endif /* INCLUDE_vTaskSuspend */
 }
 
-/*-----------------------------------------------------------*/
-/*< Support For CmBacktrace >*/
-uint32_t * vTaskStackAddr()
-{
-    return pxCurrentTCB->pxStack;
-}
-
-uint32_t vTaskStackSize()
-{
-    #if ( portSTACK_GROWTH > 0 )
-    
-    return (pxNewTCB->pxEndOfStack - pxNewTCB->pxStack + 1);
-    
-    #else /* ( portSTACK_GROWTH > 0 )*/
-    
-    return pxCurrentTCB->uxSizeOfStack;
-    
-    #endif /* ( portSTACK_GROWTH > 0 )*/
-}
-
-char * vTaskName()
-{
-    return pxCurrentTCB->pcTaskName;
-}
 /*-----------------------------------------------------------*/
 
 #ifdef FREERTOS_MODULE_TEST
@@ -32,6 +32,9 @@
 #include <rtthread.h>
 /* print line, must config by user */
 #define cmb_println(...)               rt_kprintf(__VA_ARGS__);rt_kprintf("\r\n")
+/* feed the watchdog on printing the report */
+extern void IWDG_Feed(void);
+#define cmb_wdt_feed()                 IWDG_Feed()
 /* enable OS platform */
 #define CMB_USING_OS_PLATFORM
 /* OS platform type, must config when CMB_USING_OS_PLATFORM is enable */
@@ -40,6 +43,8 @@
 #define CMB_CPU_PLATFORM_TYPE          CMB_CPU_ARM_CORTEX_M4
 /* enable dump stack information */
 #define CMB_USING_DUMP_STACK_INFO
+/* enable all threads backtrace on fault and the cmb_bt msh command */
+#define CMB_USING_ALL_THREADS_BACKTRACE
 /* language of print information */
 #define CMB_PRINT_LANGUAGE             CMB_PRINT_LANUUAGE_ENGLISH
 #endif /* _CMB_CFG_H_ */
@@ -0,0 +1,276 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# This file is part of the CmBacktrace Library.
+#
+# Copyright (c) 2016, Armink, <armink.ztl@gmail.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining
+# a copy of this software and associated documentation files (the
+# 'Software'), to deal in the Software without restriction, including
+# without limitation the rights to use, copy, modify, merge, publish,
+# distribute, sublicense, and/or sell copies of the Software, and to
+# permit persons to whom the Software is furnished to do so, subject to
+# the following conditions:
+#
+# The above copyright notice and this permission notice shall be
+# included in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+# MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+# IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+# CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+# TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+# SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+# Function: Generate the vector table trampolines for CMB_USING_IRQ_RECORDER.
+#           The startup file (GCC, IAR or Keil) is copied to the output directory with the vector table entries
+#           redirected to the trampolines, and the trampolines are generated on cmb_irq_trampoline.S.
+#           Each trampoline calls cm_backtrace_irq_record() then jumps to the real handler with EXC_RETURN on LR.
+# Created on: 2026-10-18
+#
+# Usage: python cmb_irq_trampoline.py [-e Handler,...] startup_xxx.s output_dir
+#
+
+import argparse
+import os
+import re
+import sys
+
+# the vector table label on startup file
+VECTOR_TABLE_LABELS = ('g_pfnVectors', '__isr_vector', '__Vectors', '__vector_table')
+
+# the vector table index which isn't redirected: initial SP, Reset, NMI, HardFault, MemManage, BusFault, UsageFault.
+# the fault handlers are CmBacktrace's, and NMI can't be masked when the record index is reserved.
+SKIPPED_VECTOR_MAX_INDEX = 6
+
+TRAMPOLINE_SUFFIX = '_cmb'
+
+ENTRY_PATTERN = {
+    'gcc': re.compile(r'^(?P<head>\s*(?:\w+:)?\s*\.word\s+)(?P<name>[\w.()]+)(?P<tail>.*)$'),
+    'iar': re.compile(r'^(?P<head>\s*(?:\w+:?\s+)?DCD\s+)(?P<name>[\w.()]+)(?P<tail>.*)$'),
+    'keil': re.compile(r'^(?P<head>\s*(?:\w+\s+)?DCD\s+)(?P<name>[\w.()]+)(?P<tail>.*)$'),
+}
+
+COMMENT_PATTERN = {
+    'gcc': re.compile(r'^\s*(/\*.*\*/|@.*|//.*)?\s*$'),
+    'iar': re.compile(r'^\s*(;.*|//.*)?\s*$'),
+    'keil': re.compile(r'^\s*(;.*)?\s*$'),
+}
+
+HEADER = {
+    'gcc': '''/*
+ * This file is generated by cmb_irq_trampoline.py from {startup}, please don't edit it.
+ *
+ * Function: Vector table trampolines by GCC assembly code for CMB_USING_IRQ_RECORDER
+ */
+
+.syntax unified
+.thumb
+.text
+
+/* r0: the real handler address */
+.type cmb_irq_trampoline, %function
+cmb_irq_trampoline:
+    MOV     r1, sp                  /* get stack pointer (current is MSP) */
+    PUSH    {{r0, lr}}                /* save the real handler address and EXC_RETURN */
+    MOV     r0, lr
+    MRS     r2, ipsr
+    BL      cm_backtrace_irq_record
+    POP     {{r0, r1}}
+    MOV     lr, r1                  /* restore EXC_RETURN */
+    BX      r0                      /* jump to the real handler */
+''',
+    'iar': '''; /*
+;  * This file is generated by cmb_irq_trampoline.py from {startup}, please don't edit it.
+;  *
+;  * Function: Vector table trampolines by EWARM assembly code for CMB_USING_IRQ_RECORDER
+;  */
+
+    SECTION    .text:CODE(2)
+    THUMB
+    REQUIRE8
+    PRESERVE8
+
+    IMPORT cm_backtrace_irq_record
+
+; r0: the real handler address
+cmb_irq_trampoline:
+    MOV     r1, sp                  ; get stack pointer (current is MSP)
+    PUSH    {{r0, lr}}                ; save the real handler address and EXC_RETURN
+    MOV     r0, lr
+    MRS     r2, ipsr
+    BL      cm_backtrace_irq_record
+    POP     {{r0, r1}}
+    MOV     lr, r1                  ; restore EXC_RETURN
+    BX      r0                      ; jump to the real handler
+''',
+    'keil': '''; /*
+;  * This file is generated by cmb_irq_trampoline.py from {startup}, please don't edit it.
+;  *
+;  * Function: Vector table trampolines by MDK-ARM assembly code for CMB_USING_IRQ_RECORDER
+;  */
+
+    AREA |.text|, CODE, READONLY, ALIGN=2
+    THUMB
+    REQUIRE8
+    PRESERVE8
+
+    IMPORT cm_backtrace_irq_record
+
+; r0: the real handler address
+cmb_irq_trampoline    PROC
+    MOV     r1, sp                  ; get stack pointer (current is MSP)
+    PUSH    {{r0, lr}}                ; save the real handler address and EXC_RETURN
+    MOV     r0, lr
+    MRS     r2, ipsr
+    BL      cm_backtrace_irq_record
+    POP     {{r0, r1}}
+    MOV     lr, r1                  ; restore EXC_RETURN
+    BX      r0                      ; jump to the real handler
+    ENDP
+''',
+}
+
+TRAMPOLINE = {
+    'gcc': '''
+.global {name}{suffix}
+.type {name}{suffix}, %function
+{name}{suffix}:
+    LDR     r0, ={name}
+    B       cmb_irq_trampoline
+    .ltorg
+''',
+    'iar': '''
+    IMPORT {name}
+    EXPORT {name}{suffix}
+{name}{suffix}:
+    LDR     r0, ={name}
+    B       cmb_irq_trampoline
+    LTORG
+''',
+    'keil': '''
+    IMPORT {name}
+    EXPORT {name}{suffix}
+{name}{suffix}    PROC
+    LDR     r0, ={name}
+    B       cmb_irq_trampoline
+    ENDP
+    LTORG
+''',
+}
+
+FOOTER = {
+    'gcc': '',
+    'iar': '\n    END\n',
+    'keil': '\n    END\n',
+}
+
+# the trampolines must be declared on startup file for IAR and Keil assembler
+EXTERN_DECLARE = {
+    'gcc': None,
+    'iar': '        EXTERN  {name}{suffix}\n',
+    'keil': '                IMPORT  {name}{suffix}\n',
+}
+
+
+def detect_toolchain(lines):
+    for line in lines:
+        if re.match(r'^\s*AREA\s', line):
+            return 'keil'
+        if re.match(r'^\s*SECTION\s', line):
+            return 'iar'
+        if re.match(r'^\s*\.(section|word|syntax)\b', line):
+            return 'gcc'
+    return None
+
+
+def find_vector_table(lines, toolchain, label):
+    """
+    find the vector table entries
+
+    :return: the label line number and the list of (line number, regex match) of entries
+    """
+    labels = (label,) if label else VECTOR_TABLE_LABELS
+    label_pattern = re.compile(r'^\s*(?P<label>' + '|'.join(re.escape(l) for l in labels) + r')(:|\s|$)')
+    start = None
+    for i, line in enumerate(lines):
+        if label_pattern.match(line) and not re.match(r'^\s*(PUBLIC|EXPORT|\.global|\.globl|\.size|\.type)\b', line):
+            start = i
+            break
+    if start is None:
+        return None, []
+
+    entries = []
+    i = start
+    # the label may be on a single line (GCC, IAR) or on the first entry line (Keil)
+    if not ENTRY_PATTERN[toolchain].match(lines[i]):
+        i += 1
+    while i < len(lines):
+        match = ENTRY_PATTERN[toolchain].match(lines[i])
+        if match:
+            entries.append((i, match))
+        elif not COMMENT_PATTERN[toolchain].match(lines[i]):
+            break
+        i += 1
+
+    return start, entries
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the CmBacktrace interrupt entry recorder trampolines.')
+    parser.add_argument('startup', help='the startup file (GCC, IAR or Keil) which has the vector table')
+    parser.add_argument('output', help='the output directory for the redirected startup file and cmb_irq_trampoline.S')
+    parser.add_argument('-e', '--exclude', default='', help='the handlers which are not recorded, split by comma')
+    parser.add_argument('-l', '--label', default=None, help='the vector table label, default is auto detected')
+    parser.add_argument('-t', '--toolchain', choices=('gcc', 'iar', 'keil'), default=None,
+                        help='the startup file toolchain, default is auto detected')
+    args = parser.parse_args()
+
+    with open(args.startup, 'r') as f:
+        lines = f.readlines()
+
+    toolchain = args.toolchain or detect_toolchain(lines)
+    if toolchain is None:
+        sys.exit('Error: the toolchain of %s is unknown, please set it by --toolchain' % args.startup)
+
+    start, entries = find_vector_table(lines, toolchain, args.label)
+    if not entries:
+        sys.exit('Error: the vector table is not found on %s, please set its label by --label' % args.startup)
+
+    excluded = set(name.strip() for name in args.exclude.split(',') if name.strip())
+    handlers = []
+    for index, (line_num, match) in enumerate(entries):
+        name = match.group('name')
+        if index <= SKIPPED_VECTOR_MAX_INDEX or name in excluded or not re.match(r'^[A-Za-z_]\w*$', name):
+            continue
+        lines[line_num] = match.group('head') + name + TRAMPOLINE_SUFFIX + match.group('tail') + '\n'
+        if name not in handlers:
+            handlers.append(name)
+
+    if EXTERN_DECLARE[toolchain]:
+        lines[start:start] = [EXTERN_DECLARE[toolchain].format(name=name, suffix=TRAMPOLINE_SUFFIX)
+                              for name in handlers]
+
+    if not os.path.isdir(args.output):
+        os.makedirs(args.output)
+    startup_name = os.path.basename(args.startup)
+    if os.path.abspath(os.path.join(args.output, startup_name)) == os.path.abspath(args.startup):
+        sys.exit('Error: the output directory can\'t be the startup file directory')
+
+    with open(os.path.join(args.output, startup_name), 'w') as f:
+        f.writelines(lines)
+
+    with open(os.path.join(args.output, 'cmb_irq_trampoline.S'), 'w') as f:
+        f.write(HEADER[toolchain].format(startup=startup_name))
+        for name in handlers:
+            f.write(TRAMPOLINE[toolchain].format(name=name, suffix=TRAMPOLINE_SUFFIX))
+        f.write(FOOTER[toolchain])
+
+    print('%d handlers of %s (%s) are redirected to %s' % (len(handlers), startup_name, toolchain,
+                                                          os.path.join(args.output, 'cmb_irq_trampoline.S')))
+
+
+if __name__ == '__main__':
+    main()
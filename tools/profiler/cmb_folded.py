@@ -0,0 +1,86 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# This file is part of the CmBacktrace Library.
+#
+# Copyright (c) 2016, Armink, <armink.ztl@gmail.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining
+# a copy of this software and associated documentation files (the
+# 'Software'), to deal in the Software without restriction, including
+# without limitation the rights to use, copy, modify, merge, publish,
+# distribute, sublicense, and/or sell copies of the Software, and to
+# permit persons to whom the Software is furnished to do so, subject to
+# the following conditions:
+#
+# The above copyright notice and this permission notice shall be
+# included in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+# MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+# IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+# CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+# TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+# SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+# Function: Convert the folded stacks addresses which are dumped by cm_backtrace_profiler_dump() to function names
+#           by addr2line, the output can be drawn by flamegraph.pl (https://github.com/brendangregg/FlameGraph).
+# Created on: 2026-10-18
+#
+# Usage: python cmb_folded.py [-a addr2line] firmware.axf profiler.log > profiler.folded
+#        flamegraph.pl profiler.folded > profiler.svg
+#
+
+import argparse
+import collections
+import re
+import subprocess
+import sys
+
+FOLDED_PATTERN = re.compile(r'((?:[0-9a-fA-F]{8};)*[0-9a-fA-F]{8}) (\d+)\s*$')
+
+
+def addr2func(addr2line, elf, addresses):
+    """
+    convert the addresses to function names by one addr2line process
+
+    :return: the dict of address to function name
+    """
+    if not addresses:
+        return {}
+    output = subprocess.check_output([addr2line, '-e', elf, '-f', '-C'] + ['0x' + addr for addr in addresses])
+    lines = output.decode('utf-8', 'replace').splitlines()
+    # addr2line prints function name and file:line for each address
+    return dict((addr, lines[i * 2].strip() or addr) for i, addr in enumerate(addresses))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert the CmBacktrace profiler folded stacks to function names.')
+    parser.add_argument('elf', help='the firmware file which has debug information, e.g., rtthread.axf')
+    parser.add_argument('log', nargs='?', default='-', help='the log which has the dumped folded stacks, default is stdin')
+    parser.add_argument('-a', '--addr2line', default='addr2line', help='the addr2line, e.g., arm-none-eabi-addr2line')
+    args = parser.parse_args()
+
+    log = sys.stdin if args.log == '-' else open(args.log, 'r')
+    stacks = []
+    for line in log:
+        match = FOLDED_PATTERN.search(line)
+        if match:
+            stacks.append((match.group(1).lower().split(';'), int(match.group(2))))
+
+    addresses = sorted(set(addr for stack, _ in stacks for addr in stack))
+    funcs = addr2func(args.addr2line, args.elf, addresses)
+
+    # the different addresses on same functions are merged
+    folded = collections.OrderedDict()
+    for stack, count in stacks:
+        key = ';'.join(funcs[addr] for addr in stack)
+        folded[key] = folded.get(key, 0) + count
+
+    for key, count in folded.items():
+        print('%s %d' % (key, count))
+
+
+if __name__ == '__main__':
+    main()